@@ -0,0 +1,1126 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+// clang-format off
+#ifdef PATHFINDER_USE_OPENGL
+#include "pathfinder/gpu/gl/window_builder.h"
+#endif
+#ifdef PATHFINDER_USE_VULKAN
+#include "pathfinder/gpu/vk/window_builder.h"
+#endif
+// clang-format on
+
+#include "app.h"
+#include "common/any_callable.h"
+#include "nodes/proxy_window.h"
+#include "render/render_target_pool.h"
+#include "servers/profiler.h"
+#include "servers/timer_server.h"
+#include "servers/translation_server.h"
+#include "servers/vector_server.h"
+
+using namespace vecgui;
+
+/// Headless benchmark suite. Every scenario builds a scene in a fresh headless app, then runs a fixed number of
+/// frames with a fixed time step and synthetic input, so runs are reproducible. Per-phase times come from the
+/// profiler zones (build with VECGUI_PROFILER), and the report can be written as JSON to diff between releases.
+///
+/// Usage: vecgui_bench [--frames N] [--filter NAME] [--json PATH] [--gpu] [--pipelined] [--render-level LEVEL]
+///
+/// Without --gpu nothing is drawn, so the draw phases are missing from the report. With --pipelined, frames are
+/// tiled and presented on a render thread (see SceneTree::set_pipelined_rendering()), so compare the frame times
+/// of redraw_20k with and without it for the throughput gained. --render-level takes d3d9 (the default), d3d11 or
+/// auto, see RenderLevel, and works on a software Vulkan implementation too.
+
+const Vec2I BENCH_WINDOW_SIZE = {1280, 720};
+
+constexpr double BENCH_FIXED_DT = 1.0 / 60.0;
+
+/// Mouse events per frame in the mouse storm, as a 1000 Hz mouse would produce at 60 FPS.
+constexpr int MOUSE_EVENTS_PER_FRAME = 17;
+
+constexpr uint32_t BENCH_SEED = 42;
+
+/// Zones reported as phases, in frame order. "Shape" runs inside the others, mostly "Calc minimum size".
+const char *BENCH_PHASES[] = {
+    "Input",
+    "Update",
+    "Timers",
+    "Shape",
+    "Calc minimum size",
+    "Layout",
+    "Transform",
+    "Draw window",
+    "Wait for render thread",
+    "Canvas draw",
+    "Blit",
+    "Present",
+};
+
+struct Stats {
+    double mean = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double max = 0;
+};
+
+Stats get_stats(std::vector<double> samples) {
+    Stats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::ranges::sort(samples);
+
+    auto percentile = [&](double p) { return samples[(size_t)(p * (samples.size() - 1) + 0.5)]; };
+
+    for (auto sample : samples) {
+        stats.mean += sample;
+    }
+    stats.mean /= samples.size();
+    stats.p50 = percentile(0.5);
+    stats.p95 = percentile(0.95);
+    stats.max = samples.back();
+
+    return stats;
+}
+
+struct ScenarioResult {
+    std::string name;
+
+    /// Building the scene, in milliseconds.
+    double setup_ms = 0;
+
+    /// The first frame readies and lays out the whole scene, so it's reported apart from the others.
+    double first_frame_ms = 0;
+
+    /// Per frame, in milliseconds.
+    Stats frame_ms;
+
+    /// By zone name, per frame, in milliseconds.
+    std::map<std::string, Stats> phases_ms;
+
+    /// By counter name, the mean per frame.
+    std::map<std::string, double> counters;
+
+    /// Scenario-specific numbers.
+    std::map<std::string, double> metrics;
+};
+
+struct BenchOptions {
+    uint32_t frames = 120;
+    std::string filter;
+    std::string json_path;
+    bool gpu = false;
+    bool pipelined = false;
+    RenderLevel render_level = RenderLevel::D3d9;
+};
+
+class Bench {
+public:
+    Bench(const BenchOptions &options,
+          std::shared_ptr<Pathfinder::Device> device,
+          std::shared_ptr<Pathfinder::Queue> queue)
+        : options_(options), device_(std::move(device)), queue_(std::move(queue)) {
+    }
+
+    void begin(const std::string &name) {
+        result_ = {};
+        result_.name = name;
+
+        app_ = App::create_headless(BENCH_WINDOW_SIZE, false, device_, queue_, options_.render_level);
+        app_->set_fixed_dt(BENCH_FIXED_DT);
+        app_->get_tree()->set_pipelined_rendering(options_.pipelined);
+
+        Profiler::get_singleton()->clear();
+    }
+
+    /// Build the scene under the tree root.
+    void setup(const std::function<void(Node &root)> &build) {
+        auto start = std::chrono::steady_clock::now();
+        build(*app_->get_tree_root());
+        result_.setup_ms = get_ms_since(start);
+    }
+
+    /// Run the first frame, then the measured ones. `before_frame` gets the frame index and may push input or
+    /// change the scene.
+    void run_frames(const std::function<void(uint32_t frame)> &before_frame = nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        app_->single_run();
+        result_.first_frame_ms = get_ms_since(start);
+
+        std::vector<double> frame_ms;
+        std::map<std::string, std::vector<double>> phase_ms;
+        std::map<std::string, double> counter_sums;
+
+        auto profiler = Profiler::get_singleton();
+
+        for (uint32_t frame = 0; frame < options_.frames; frame++) {
+            auto zone_totals_before = get_zone_totals_ms();
+
+            auto frame_start = std::chrono::steady_clock::now();
+
+            if (before_frame) {
+                before_frame(frame);
+            }
+            app_->single_run();
+
+            // With pipelined rendering, the last frame is still in flight.
+            if (frame + 1 == options_.frames) {
+                app_->get_tree()->finish_rendering();
+            }
+
+            frame_ms.push_back(get_ms_since(frame_start));
+
+            auto zone_totals_after = get_zone_totals_ms();
+            for (auto phase : BENCH_PHASES) {
+                if (zone_totals_after.contains(phase)) {
+                    phase_ms[phase].push_back(zone_totals_after[phase] - zone_totals_before[phase]);
+                }
+            }
+
+            for (size_t counter = 0; counter < (size_t)ProfileCounter::Max; counter++) {
+                uint32_t sum = 0;
+                for (size_t type = 0; type < (size_t)NodeType::Max; type++) {
+                    sum += profiler->get_frame_count((NodeType)type, (ProfileCounter)counter);
+                }
+                counter_sums[get_profile_counter_name((ProfileCounter)counter)] += sum;
+            }
+        }
+
+        result_.frame_ms = get_stats(frame_ms);
+
+        for (auto &[phase, samples] : phase_ms) {
+            result_.phases_ms[phase] = get_stats(samples);
+        }
+
+        for (auto &[counter, sum] : counter_sums) {
+            result_.counters[counter] = options_.frames > 0 ? sum / options_.frames : 0;
+        }
+    }
+
+    void set_metric(const std::string &name, double value) {
+        result_.metrics[name] = value;
+    }
+
+    uint32_t get_frame_count() const {
+        return options_.frames;
+    }
+
+    SceneTree *get_tree() const {
+        return app_->get_tree();
+    }
+
+    ScenarioResult end() {
+        app_.reset();
+        return result_;
+    }
+
+    static double get_ms_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    static std::map<std::string, double> get_zone_totals_ms() {
+        std::map<std::string, double> totals;
+        for (auto &zone : Profiler::get_singleton()->get_zone_totals()) {
+            totals[zone.name] = zone.duration / 1e6;
+        }
+        return totals;
+    }
+
+    BenchOptions options_;
+
+    std::shared_ptr<Pathfinder::Device> device_;
+    std::shared_ptr<Pathfinder::Queue> queue_;
+
+    std::unique_ptr<App> app_;
+
+    ScenarioResult result_;
+};
+
+// Scenarios.
+
+void bench_buttons_10k(Bench &bench) {
+    bench.setup([](Node &root) {
+        auto scroll_container = std::make_shared<ScrollContainer>();
+        scroll_container->set_anchor_flag(AnchorFlag::FullRect);
+        root.add_child(scroll_container);
+
+        auto vbox = std::make_shared<VBoxContainer>();
+        scroll_container->add_child(vbox);
+
+        for (int i = 0; i < 10000; i++) {
+            auto button = make_node<Button>();
+            button->set_text("Button " + std::to_string(i));
+            vbox->add_child(button);
+        }
+    });
+
+    bench.run_frames();
+}
+
+void bench_tree_100k(Bench &bench) {
+    bench.setup([](Node &root) {
+        auto tree = std::make_shared<Tree>();
+        tree->set_anchor_flag(AnchorFlag::FullRect);
+        root.add_child(tree);
+
+        auto tree_root = tree->create_item(nullptr, "Root");
+        for (int i = 0; i < 1000; i++) {
+            auto branch = tree->create_item(tree_root, "Branch " + std::to_string(i));
+            for (int j = 0; j < 99; j++) {
+                tree->create_item(branch, "Leaf " + std::to_string(j));
+            }
+        }
+    });
+
+    auto center = BENCH_WINDOW_SIZE.to_f32() * 0.5f;
+
+    bench.run_frames([&](uint32_t frame) {
+        InputServer::get_singleton()->push_mouse_motion(0, center);
+        InputServer::get_singleton()->push_mouse_scroll(0, {0, frame % 20 < 10 ? -1.0f : 1.0f});
+    });
+}
+
+void bench_text_edit_1mb_typing(Bench &bench) {
+    std::shared_ptr<TextEdit> text_edit;
+
+    bench.setup([&](Node &root) {
+        text_edit = std::make_shared<TextEdit>();
+        text_edit->set_anchor_flag(AnchorFlag::FullRect);
+        root.add_child(text_edit);
+
+        const std::string line = "The quick brown fox jumps over the lazy dog. Pack my box with five dozen jugs.\n";
+
+        std::string text;
+        text.reserve(1 << 20);
+        while (text.size() + line.size() <= 1 << 20) {
+            text += line;
+        }
+        text_edit->set_text(text);
+    });
+
+    text_edit->grab_focus();
+
+    bench.run_frames([](uint32_t frame) {
+        auto input_server = InputServer::get_singleton();
+
+        // Type a letter per frame, and delete one every fourth frame.
+        if (frame % 4 == 3) {
+            input_server->push_key(0, KeyCode::Backspace, true);
+            input_server->push_key(0, KeyCode::Backspace, false);
+        } else {
+            input_server->push_text(0, 'a' + frame % 26);
+        }
+    });
+}
+
+void bench_wrapped_label_resize(Bench &bench) {
+    std::shared_ptr<VBoxContainer> vbox;
+
+    bench.setup([&](Node &root) {
+        vbox = std::make_shared<VBoxContainer>();
+        vbox->set_size(BENCH_WINDOW_SIZE.to_f32());
+        root.add_child(vbox);
+
+        std::string text;
+        for (int i = 0; i < 8; i++) {
+            text += "Word wrapping has to reshape and break every line again whenever the width changes. ";
+        }
+
+        for (int i = 0; i < 200; i++) {
+            auto label = std::make_shared<Label>();
+            label->set_word_wrap(true);
+            label->set_text(text);
+            label->container_sizing.flag_h = ContainerSizingFlag::Fill;
+            vbox->add_child(label);
+        }
+    });
+
+    // Drag the width back and forth between 200 and 1200 pixels.
+    bench.run_frames([&](uint32_t frame) {
+        auto phase = frame % 60;
+        auto t = phase < 30 ? phase / 30.0f : (60 - phase) / 30.0f;
+        vbox->set_size({200 + t * 1000, (float)BENCH_WINDOW_SIZE.y});
+    });
+}
+
+void bench_window_resize_drag(Bench &bench) {
+    auto render_server = RenderServer::get_singleton();
+    auto render_target_pool = RenderTargetPool::get_singleton();
+
+    bench.setup([](Node &root) {
+        auto grid = std::make_shared<GridContainer>();
+        grid->set_column_limit(20);
+        root.add_child(grid);
+
+        for (int i = 0; i < 400; i++) {
+            auto button = std::make_shared<Button>();
+            button->set_text(std::to_string(i));
+            grid->add_child(button);
+        }
+    });
+
+    auto allocations_before = render_target_pool->get_allocation_count();
+    uint32_t allocations_after_first_drag = 0;
+
+    // Drag the bottom-right corner of the primary window back and forth, a pixel range at a time.
+    bench.run_frames([&](uint32_t frame) {
+        auto phase = frame % 60;
+        auto t = phase < 30 ? phase / 30.0f : (60 - phase) / 30.0f;
+        auto size = Vec2I(BENCH_WINDOW_SIZE.x - 600 * t, BENCH_WINDOW_SIZE.y - 400 * t);
+
+        render_server->create_headless_window(size, 0);
+        bench.get_tree()->notify_primary_window_size_changed(size);
+
+        if (frame == 60) {
+            allocations_after_first_drag = render_target_pool->get_allocation_count();
+        }
+    });
+
+    // Without a device, nothing is drawn, so nothing is allocated.
+    auto allocations = render_target_pool->get_allocation_count() - allocations_before;
+    bench.set_metric("render_target_allocations", allocations);
+    if (allocations_after_first_drag > 0) {
+        bench.set_metric("render_target_allocations_after_warm_up",
+                         render_target_pool->get_allocation_count() - allocations_after_first_drag);
+    }
+
+    render_server->create_headless_window(BENCH_WINDOW_SIZE, 0);
+}
+
+void bench_deep_nesting(Bench &bench) {
+    constexpr int depth = 500;
+
+    std::shared_ptr<Label> leaf;
+
+    bench.setup([&](Node &root) {
+        Node *parent = &root;
+        for (int i = 0; i < depth; i++) {
+            auto margin_container = std::make_shared<MarginContainer>();
+            margin_container->set_margin_all(1);
+            parent->add_child(margin_container);
+            parent = margin_container.get();
+        }
+
+        leaf = std::make_shared<Label>();
+        leaf->set_text("Leaf");
+        parent->add_child(leaf);
+    });
+
+    bench.set_metric("depth", depth);
+
+    // Every change at the leaf has to propagate to the root.
+    bench.run_frames([&](uint32_t frame) { leaf->set_custom_minimum_size({(float)(frame % 100), 0}); });
+}
+
+void bench_locale_switch(Bench &bench) {
+    // Translations go through a file, like they would in an app.
+    auto csv_path = (std::filesystem::temp_directory_path() / "vecgui_bench_translations.csv").string();
+    {
+        std::ofstream csv(csv_path);
+        csv << "tag,en,zh,ja,ar,ru,hi\n";
+        csv << "HELLO,Hello world!,你好世界！,こんにちは世界！,مرحبا بالعالم!,Привет мир,नमस्ते दुनिया!\n";
+        csv << "OPEN,Open file,打开文件,ファイルを開く,افتح الملف,Открыть файл,फ़ाइल खोलें\n";
+        csv << "SAVE,Save changes,保存更改,変更を保存,احفظ التغييرات,Сохранить изменения,परिवर्तन सहेजें\n";
+        csv << "QUIT,Quit,退出,終了,خروج,Выход,बाहर निकलें\n";
+    }
+
+    auto translation_server = TranslationServer::get_singleton();
+    translation_server->load_translations(csv_path);
+
+    const std::vector<std::string> tags = {"HELLO", "OPEN", "SAVE", "QUIT"};
+    const std::vector<std::string> locales = {"en", "zh", "ja", "ar", "ru", "hi"};
+
+    std::vector<std::shared_ptr<Label>> labels;
+
+    bench.setup([&](Node &root) {
+        auto grid = std::make_shared<GridContainer>();
+        grid->set_column_limit(100);
+        root.add_child(grid);
+
+        for (int i = 0; i < 10000; i++) {
+            auto label = std::make_shared<Label>();
+            label->set_text(FTR(tags[i % tags.size()]));
+            grid->add_child(label);
+            labels.push_back(label);
+        }
+    });
+
+    // Switch the locale every frame, relabeling everything.
+    bench.run_frames([&](uint32_t frame) {
+        translation_server->set_locale(locales[(frame + 1) % locales.size()]);
+
+        for (size_t i = 0; i < labels.size(); i++) {
+            labels[i]->set_text(FTR(tags[i % tags.size()]));
+        }
+    });
+
+    translation_server->set_locale("en");
+
+    std::filesystem::remove(csv_path);
+}
+
+void bench_mouse_move_storm(Bench &bench) {
+    bench.setup([](Node &root) {
+        auto grid = std::make_shared<GridContainer>();
+        grid->set_column_limit(100);
+        grid->set_separation(2);
+        root.add_child(grid);
+
+        for (int i = 0; i < 10000; i++) {
+            auto button = std::make_shared<Button>();
+            button->set_text(std::to_string(i));
+            grid->add_child(button);
+        }
+    });
+
+    std::mt19937 rng(BENCH_SEED);
+    std::uniform_real_distribution<float> x(0, BENCH_WINDOW_SIZE.x);
+    std::uniform_real_distribution<float> y(0, BENCH_WINDOW_SIZE.y);
+
+    // Mostly motion, with a click now and then so captures are exercised too.
+    bench.run_frames([&](uint32_t frame) {
+        auto input_server = InputServer::get_singleton();
+
+        for (int i = 0; i < MOUSE_EVENTS_PER_FRAME; i++) {
+            input_server->push_mouse_motion(0, {x(rng), y(rng)});
+        }
+
+        if (frame % 10 == 0) {
+            input_server->push_mouse_button(0, 0, true);
+            input_server->push_mouse_button(0, 0, false);
+        }
+    });
+
+    bench.set_metric("mouse_events_per_frame", MOUSE_EVENTS_PER_FRAME);
+}
+
+void bench_static_scene_50k(Bench &bench) {
+    bench.setup([](Node &root) {
+        auto grid = std::make_shared<GridContainer>();
+        grid->set_column_limit(250);
+        root.add_child(grid);
+
+        for (int i = 0; i < 50000; i++) {
+            if (i % 2 == 0) {
+                auto label = std::make_shared<Label>();
+                label->set_text(std::to_string(i));
+                grid->add_child(label);
+            } else {
+                auto panel = std::make_shared<Panel>();
+                panel->set_custom_minimum_size({8, 8});
+                grid->add_child(panel);
+            }
+        }
+    });
+
+    // Nothing changes, so this is the cost of an idle frame.
+    bench.run_frames();
+}
+
+void bench_redraw_20k(Bench &bench) {
+    std::shared_ptr<ProgressBar> progress_bar;
+
+    bench.setup([&](Node &root) {
+        auto vbox = std::make_shared<VBoxContainer>();
+        root.add_child(vbox);
+
+        progress_bar = std::make_shared<ProgressBar>();
+        vbox->add_child(progress_bar);
+
+        auto grid = std::make_shared<GridContainer>();
+        grid->set_column_limit(100);
+        vbox->add_child(grid);
+
+        for (int i = 0; i < 20000; i++) {
+            if (i % 2 == 0) {
+                auto label = std::make_shared<Label>();
+                label->set_text(std::to_string(i));
+                grid->add_child(label);
+            } else {
+                auto panel = std::make_shared<Panel>();
+                panel->set_custom_minimum_size({8, 8});
+                grid->add_child(panel);
+            }
+        }
+    });
+
+    // A heavy scene redrawn every frame, so recording, tiling and presenting dominate.
+    bench.run_frames([&](uint32_t frame) { progress_bar->set_value(frame % 100); });
+}
+
+void bench_text_screen(Bench &bench) {
+    std::vector<std::shared_ptr<Label>> labels;
+
+    bench.setup([&](Node &root) {
+        auto vbox = std::make_shared<VBoxContainer>();
+        root.add_child(vbox);
+
+        // About 5k glyphs filling the window.
+        for (int i = 0; i < 36; i++) {
+            auto label = std::make_shared<Label>();
+            label->set_text("Line " + std::to_string(i) +
+                            ": the quick brown fox jumps over the lazy dog, then does it all over again, "
+                            "and keeps on jumping until the line runs out of room.");
+            vbox->add_child(label);
+            labels.push_back(label);
+        }
+    });
+
+    // Text is unchanged but redrawn every frame, so recording and tiling the glyphs dominate. See the
+    // "Canvas paths" counter and the "Canvas draw" phase, which needs --gpu.
+    bench.run_frames([&](uint32_t frame) { labels[frame % labels.size()]->queue_redraw(); });
+}
+
+void bench_multi_window_4(Bench &bench) {
+    // The primary window plus three more, all of different sizes.
+    const std::vector<Vec2I> extra_window_sizes = {{960, 640}, {640, 480}, {320, 240}};
+
+    std::vector<std::shared_ptr<ProgressBar>> progress_bars;
+
+    bench.setup([&](Node &root) {
+        std::vector<Node *> window_roots = {&root};
+
+        for (auto size : extra_window_sizes) {
+            auto window = std::make_shared<ProxyWindow>(size, -1);
+            root.add_child(window);
+            window_roots.push_back(window.get());
+        }
+
+        for (auto window_root : window_roots) {
+            auto grid = std::make_shared<GridContainer>();
+            grid->set_column_limit(20);
+            window_root->add_child(grid);
+
+            for (int i = 0; i < 500; i++) {
+                auto button = std::make_shared<Button>();
+                button->set_text(std::to_string(i));
+                grid->add_child(button);
+            }
+
+            auto progress_bar = std::make_shared<ProgressBar>();
+            grid->add_child(progress_bar);
+            progress_bars.push_back(progress_bar);
+        }
+    });
+
+    // One window changes per frame, the others should be skipped.
+    uint64_t drawn_windows = 0;
+
+    bench.run_frames([&](uint32_t frame) {
+        progress_bars[frame % progress_bars.size()]->set_value(frame % 100);
+
+        if (frame > 0) {
+            drawn_windows += bench.get_tree()->get_drawn_window_count();
+        }
+    });
+    drawn_windows += bench.get_tree()->get_drawn_window_count();
+
+    bench.set_metric("windows", progress_bars.size());
+    bench.set_metric("drawn_windows_per_frame", (double)drawn_windows / bench.get_frame_count());
+}
+
+void bench_timers_100k(Bench &bench) {
+    auto timer_server = TimerServer::get_singleton();
+
+    std::mt19937 rng(BENCH_SEED);
+    std::uniform_real_distribution<double> delay(0, 10);
+
+    uint64_t fired = 0;
+    std::vector<TimerId> timers;
+
+    bench.setup([&](Node &) {
+        for (int i = 0; i < 100000; i++) {
+            auto interval = i % 2 == 0 ? delay(rng) : 0;
+            timers.push_back(timer_server->start(delay(rng), [&fired] { fired++; }, interval));
+        }
+    });
+
+    bench.run_frames();
+
+    bench.set_metric("timers_fired_per_frame", (double)fired / (bench.get_frame_count() + 1));
+
+    for (auto timer : timers) {
+        timer_server->stop(timer);
+    }
+}
+
+void bench_signal_emit(Bench &bench) {
+    constexpr int connection_count = 16;
+    constexpr int emit_count = 1000000;
+
+    uint64_t sum = 0;
+
+    Signal<int> signal;
+    for (int i = 0; i < connection_count; i++) {
+        signal.connect([&sum](int value) { sum += value; });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < emit_count; i++) {
+        signal.emit(i);
+    }
+    auto signal_ms = Bench::get_ms_since(start);
+
+    // The type-erased callbacks nodes used to keep, invoked the way they were, as the baseline.
+    std::vector<AnyCallable<void>> callbacks;
+    for (int i = 0; i < connection_count; i++) {
+        callbacks.emplace_back([&sum](int value) { sum += value; });
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < emit_count; i++) {
+        for (auto &callback : callbacks) {
+            try {
+                callback.operator()<int>(int(i));
+            } catch (std::bad_any_cast &) {
+                Logger::error("Mismatched signal argument types!", "revector");
+            }
+        }
+    }
+    auto any_callable_ms = Bench::get_ms_since(start);
+
+    bench.set_metric("emits_per_second", emit_count / (signal_ms / 1000.0));
+    bench.set_metric("slot_calls_per_second", (double)emit_count * connection_count / (signal_ms / 1000.0));
+    bench.set_metric("any_callable_emits_per_second", emit_count / (any_callable_ms / 1000.0));
+    bench.set_metric("speedup_over_any_callable", any_callable_ms / signal_ms);
+
+    // Keep the slots from being optimized away.
+    bench.set_metric("checksum", (double)(sum % 1000));
+}
+
+/// Nodes reachable from `node`, visited the way the engine walks a tree.
+uint64_t count_subtree(Node *node) {
+    uint64_t count = 1;
+    for (auto &child : node->get_all_children()) {
+        count += count_subtree(child.get());
+    }
+    return count;
+}
+
+/// Build, walk and free detached trees of buttons, whose constructors create embedded children, once with
+/// std::make_shared and once with make_node(). Walking is where the arena's packing pays off, in fewer cache misses.
+void bench_node_allocation(Bench &bench) {
+    constexpr int button_count = 10000;
+    constexpr int walk_count = 20;
+
+    auto run = [&]<bool UseArena>(const std::string &prefix) {
+        auto start = std::chrono::steady_clock::now();
+
+        auto vbox = std::make_shared<VBoxContainer>();
+        for (int i = 0; i < button_count; i++) {
+            std::shared_ptr<Button> button;
+            if constexpr (UseArena) {
+                button = make_node<Button>();
+            } else {
+                button = std::make_shared<Button>();
+            }
+            vbox->add_child(button);
+        }
+        bench.set_metric(prefix + "_construct_ms", Bench::get_ms_since(start));
+
+        start = std::chrono::steady_clock::now();
+        uint64_t node_count = 0;
+        for (int i = 0; i < walk_count; i++) {
+            node_count += count_subtree(vbox.get());
+        }
+        bench.set_metric(prefix + "_walk_ms", Bench::get_ms_since(start) / walk_count);
+        bench.set_metric("nodes", (double)node_count / walk_count);
+
+        start = std::chrono::steady_clock::now();
+        vbox.reset();
+        bench.set_metric(prefix + "_destroy_ms", Bench::get_ms_since(start));
+    };
+
+    run.template operator()<false>("make_shared");
+    run.template operator()<true>("arena");
+}
+
+/// The node type questions the tree asks per node and frame, answered with RTTI, as before NodeKind.
+uint32_t count_kinds_rtti(Node *node) {
+    return (dynamic_cast<NodeUi *>(node) != nullptr) + (dynamic_cast<ProxyWindow *>(node) != nullptr) +
+           (dynamic_cast<Container *>(node) != nullptr) + (dynamic_cast<ScrollContainer *>(node) != nullptr) +
+           (dynamic_cast<CachedLayer *>(node) != nullptr);
+}
+
+uint32_t count_kinds(Node *node) {
+    return node->is_kind(NodeKind::Ui) + node->is_kind(NodeKind::Window) + node->is_kind(NodeKind::Container) +
+           node->is_kind(NodeKind::ClipsChildren) + node->is_kind(NodeKind::CachedLayer);
+}
+
+/// Walk a deep tree of mixed containers once per frame, asking each node what it is, with dynamic_cast and with
+/// the NodeKind bitmask.
+void bench_node_kind_checks(Bench &bench) {
+    constexpr int branch_count = 50;
+    constexpr int depth = 200;
+
+    std::vector<Node *> nodes;
+
+    bench.setup([&](Node &root) {
+        for (int branch = 0; branch < branch_count; branch++) {
+            Node *parent = &root;
+            for (int i = 0; i < depth; i++) {
+                std::shared_ptr<Container> container;
+                switch (i % 3) {
+                    case 0:
+                        container = make_node<MarginContainer>();
+                        break;
+                    case 1:
+                        container = make_node<VBoxContainer>();
+                        break;
+                    default:
+                        container = make_node<ScrollContainer>();
+                        break;
+                }
+                parent->add_child(container);
+
+                auto label = make_node<Label>();
+                label->set_text("Label");
+                container->add_child(label);
+
+                parent = container.get();
+            }
+        }
+
+        dfs_preorder_ltr_traversal(&root, nodes);
+    });
+
+    auto measure = [&](uint32_t (*count)(Node *)) {
+        uint64_t kinds = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < bench.get_frame_count(); frame++) {
+            for (auto node : nodes) {
+                kinds += count(node);
+            }
+        }
+        auto elapsed_ms = Bench::get_ms_since(start);
+
+        // Keep the checks from being optimized away.
+        bench.set_metric("kinds_per_frame", (double)kinds / std::max(bench.get_frame_count(), 1u));
+
+        return elapsed_ms / std::max(bench.get_frame_count(), 1u);
+    };
+
+    auto rtti_ms = measure(count_kinds_rtti);
+    auto kind_ms = measure(count_kinds);
+
+    bench.set_metric("nodes", (double)nodes.size());
+    bench.set_metric("rtti_ms_per_frame", rtti_ms);
+    bench.set_metric("node_kind_ms_per_frame", kind_ms);
+    bench.set_metric("speedup_over_rtti", rtti_ms / kind_ms);
+}
+
+/// 100k panels in 1000 rows, whose spacing changes every frame, so every node is laid out and moved again.
+/// The phases give the per-system cost. The metrics time a bare visit of every node, once by following child
+/// pointers as the systems used to, and once by iterating the rows of the node table as they do now.
+void bench_systems_100k(Bench &bench) {
+    constexpr int row_count = 1000;
+    constexpr int column_count = 100;
+
+    std::vector<std::shared_ptr<HBoxContainer>> rows;
+
+    bench.setup([&](Node &root) {
+        auto vbox = make_node<VBoxContainer>();
+        vbox->set_anchor_flag(AnchorFlag::FullRect);
+        root.add_child(vbox);
+
+        for (int i = 0; i < row_count; i++) {
+            auto hbox = make_node<HBoxContainer>();
+            vbox->add_child(hbox);
+            rows.push_back(hbox);
+
+            for (int j = 0; j < column_count; j++) {
+                auto panel = make_node<Panel>();
+                panel->set_custom_minimum_size({4, 4});
+                hbox->add_child(panel);
+            }
+        }
+    });
+
+    bench.run_frames([&](uint32_t frame) {
+        for (auto &hbox : rows) {
+            hbox->set_separation((float)(frame % 2));
+        }
+    });
+
+    auto root = bench.get_tree()->get_root();
+    auto &table = bench.get_tree()->get_node_table();
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t pointer_count = count_subtree(root.get());
+    bench.set_metric("pointer_walk_ms", Bench::get_ms_since(start));
+
+    start = std::chrono::steady_clock::now();
+    float width_sum = 0;
+    for (uint32_t row = 0; row < table.size(); row++) {
+        width_sum += table.sizes[row].x;
+    }
+    bench.set_metric("table_walk_ms", Bench::get_ms_since(start));
+
+    bench.set_metric("nodes", (double)pointer_count);
+    // Keep the walk from being optimized away.
+    bench.set_metric("checksum", width_sum > 0 ? 1 : 0);
+}
+
+void bench_draw_primitives(Bench &bench) {
+    constexpr int primitive_count = 100000;
+
+    auto vector_server = VectorServer::get_singleton();
+
+    // Headless without a device has no canvas to record into.
+    if (vector_server->get_canvas() == nullptr) {
+        bench.set_metric("skipped_without_gpu", 1);
+        return;
+    }
+
+    StyleBox style_box;
+    style_box.bg_color = ColorU(80, 80, 80, 255);
+    style_box.border_color = ColorU(200, 200, 200, 255);
+    style_box.border_width = 1;
+    style_box.corner_radius = 4;
+
+    // Time recording one primitive into the canvas, in nanoseconds. Tiling and rendering aren't included.
+    auto measure_ns = [&](const std::function<void(int i)> &draw) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < primitive_count; i++) {
+            draw(i);
+        }
+        auto elapsed_ms = Bench::get_ms_since(start);
+
+        // Drop what was recorded.
+        vector_server->take_scene();
+
+        return elapsed_ms * 1e6 / primitive_count;
+    };
+
+    auto get_position = [](int i) { return Vec2F(i % 100 * 12, i / 100 % 60 * 12); };
+
+    bench.set_metric("ns_per_rectangle", measure_ns([&](int i) {
+                         vector_server->draw_rectangle(RectF(get_position(i), get_position(i) + Vec2F(10)),
+                                                       0,
+                                                       ColorU(80, 80, 80, 255),
+                                                       true);
+                     }));
+
+    bench.set_metric("ns_per_style_box",
+                     measure_ns([&](int i) { vector_server->draw_style_box(style_box, get_position(i), {10, 10}); }));
+
+    // As nodes draw with a transform pushed.
+    bench.set_metric("ns_per_local_style_box", measure_ns([&](int i) {
+                         vector_server->push_transform(Transform2::from_translation(get_position(i)));
+                         vector_server->draw_style_box(style_box, {}, {10, 10});
+                         vector_server->pop_transform();
+                     }));
+
+    // Every box crosses the edge of the clip rect, so each needs a clip path and a saved canvas state.
+    vector_server->push_clip_rect(RectF(Vec2F(5), Vec2F(BENCH_WINDOW_SIZE.x, BENCH_WINDOW_SIZE.y) - Vec2F(5)));
+    bench.set_metric("ns_per_clipped_style_box", measure_ns([&](int i) {
+                         vector_server->draw_style_box(style_box, {0, (float)(i % 60 * 12)}, {10, 10});
+                     }));
+    vector_server->pop_clip_rect();
+}
+
+struct Scenario {
+    const char *name;
+    void (*run)(Bench &bench);
+};
+
+const Scenario SCENARIOS[] = {
+    {"buttons_10k", bench_buttons_10k},
+    {"tree_100k", bench_tree_100k},
+    {"text_edit_1mb_typing", bench_text_edit_1mb_typing},
+    {"wrapped_label_resize", bench_wrapped_label_resize},
+    {"window_resize_drag", bench_window_resize_drag},
+    {"deep_nesting", bench_deep_nesting},
+    {"locale_switch", bench_locale_switch},
+    {"mouse_move_storm", bench_mouse_move_storm},
+    {"static_scene_50k", bench_static_scene_50k},
+    {"redraw_20k", bench_redraw_20k},
+    {"text_screen", bench_text_screen},
+    {"multi_window_4", bench_multi_window_4},
+    {"timers_100k", bench_timers_100k},
+    {"signal_emit", bench_signal_emit},
+    {"node_allocation", bench_node_allocation},
+    {"node_kind_checks", bench_node_kind_checks},
+    {"systems_100k", bench_systems_100k},
+    {"draw_primitives", bench_draw_primitives},
+};
+
+// Reports.
+
+void write_stats_json(std::ostream &out, const Stats &stats) {
+    out << "{\"mean\": " << stats.mean << ", \"p50\": " << stats.p50 << ", \"p95\": " << stats.p95
+        << ", \"max\": " << stats.max << "}";
+}
+
+template <typename T, typename F>
+void write_map_json(std::ostream &out, const std::map<std::string, T> &map, const std::string &indent, F write_value) {
+    out << "{";
+
+    bool first = true;
+    for (auto &[key, value] : map) {
+        out << (first ? "\n" : ",\n") << indent << "  \"" << key << "\": ";
+        write_value(value);
+        first = false;
+    }
+
+    out << (first ? "}" : "\n" + indent + "}");
+}
+
+/// Keys are sorted and numbers have a fixed precision, so reports diff cleanly.
+std::string to_json(const std::vector<ScenarioResult> &results, const BenchOptions &options) {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+
+    json << "{\n";
+    json << "  \"frames\": " << options.frames << ",\n";
+    json << "  \"fixed_dt\": " << BENCH_FIXED_DT << ",\n";
+    json << "  \"window_size\": [" << BENCH_WINDOW_SIZE.x << ", " << BENCH_WINDOW_SIZE.y << "],\n";
+    json << "  \"gpu\": " << (options.gpu ? "true" : "false") << ",\n";
+    json << "  \"pipelined\": " << (options.pipelined ? "true" : "false") << ",\n";
+    json << "  \"render_level\": \"" << (options.render_level == RenderLevel::D3d11 ? "d3d11" : "d3d9") << "\",\n";
+#ifdef VECGUI_PROFILER
+    json << "  \"profiler\": true,\n";
+#else
+    json << "  \"profiler\": false,\n";
+#endif
+    json << "  \"scenarios\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        auto &result = results[i];
+
+        json << (i == 0 ? "\n" : ",\n") << "    {\n";
+        json << "      \"name\": \"" << result.name << "\",\n";
+        json << "      \"setup_ms\": " << result.setup_ms << ",\n";
+        json << "      \"first_frame_ms\": " << result.first_frame_ms << ",\n";
+        json << "      \"frame_ms\": ";
+        write_stats_json(json, result.frame_ms);
+        json << ",\n      \"phases_ms\": ";
+        write_map_json(json, result.phases_ms, "      ", [&](const Stats &stats) { write_stats_json(json, stats); });
+        json << ",\n      \"counters\": ";
+        write_map_json(json, result.counters, "      ", [&](double value) { json << value; });
+        json << ",\n      \"metrics\": ";
+        write_map_json(json, result.metrics, "      ", [&](double value) { json << value; });
+        json << "\n    }";
+    }
+
+    json << "\n  ]\n}\n";
+
+    return json.str();
+}
+
+void print_result(const ScenarioResult &result) {
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << result.name << "\n";
+    std::cout << "  setup " << result.setup_ms << " ms, first frame " << result.first_frame_ms << " ms, frame mean "
+              << result.frame_ms.mean << " ms, p95 " << result.frame_ms.p95 << " ms\n";
+
+    for (auto &[phase, stats] : result.phases_ms) {
+        std::cout << "    " << std::left << std::setw(20) << phase << std::right << stats.mean << " ms\n";
+    }
+    for (auto &[metric, value] : result.metrics) {
+        std::cout << "    " << std::left << std::setw(20) << metric << std::right << value << "\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        auto has_value = i + 1 < argc;
+
+        if (!strcmp(argv[i], "--frames") && has_value) {
+            options.frames = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--filter") && has_value) {
+            options.filter = argv[++i];
+        } else if (!strcmp(argv[i], "--json") && has_value) {
+            options.json_path = argv[++i];
+        } else if (!strcmp(argv[i], "--gpu")) {
+            options.gpu = true;
+        } else if (!strcmp(argv[i], "--pipelined")) {
+            options.pipelined = true;
+        } else if (!strcmp(argv[i], "--render-level") && has_value && !strcmp(argv[i + 1], "d3d9")) {
+            options.render_level = RenderLevel::D3d9;
+            i++;
+        } else if (!strcmp(argv[i], "--render-level") && has_value && !strcmp(argv[i + 1], "d3d11")) {
+            options.render_level = RenderLevel::D3d11;
+            i++;
+        } else if (!strcmp(argv[i], "--render-level") && has_value && !strcmp(argv[i + 1], "auto")) {
+            options.render_level = RenderLevel::Auto;
+            i++;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--frames N] [--filter NAME] [--json PATH] [--gpu] [--pipelined]"
+                         " [--render-level d3d9|d3d11|auto]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifndef VECGUI_PROFILER
+    std::cerr << "Built without VECGUI_PROFILER, only frame times will be reported.\n";
+#endif
+
+    // Without a window or surface, so --gpu works without a display, e.g. on CI with a software Vulkan implementation.
+    std::shared_ptr<Pathfinder::WindowBuilder> window_builder;
+    std::shared_ptr<Pathfinder::Device> device;
+    std::shared_ptr<Pathfinder::Queue> queue;
+
+    if (options.gpu) {
+#ifdef PATHFINDER_USE_VULKAN
+        window_builder = Pathfinder::WindowBuilder::new_headless_impl(Pathfinder::BackendType::Vulkan);
+#endif
+        if (!window_builder) {
+            // An OpenGL context can't be created without a window.
+            std::cerr << "--gpu needs a Vulkan build.\n";
+            return EXIT_FAILURE;
+        }
+
+        device = window_builder->request_device();
+        queue = window_builder->create_queue();
+
+        // Calibrate once rather than per scenario.
+        auto level = resolve_render_level(options.render_level, device, queue);
+        options.render_level = level == Pathfinder::RenderLevel::D3d11 ? RenderLevel::D3d11 : RenderLevel::D3d9;
+    } else {
+        options.render_level = RenderLevel::D3d9;
+    }
+
+    Bench bench(options, device, queue);
+
+    std::vector<ScenarioResult> results;
+
+    for (auto &scenario : SCENARIOS) {
+        if (!options.filter.empty() && std::string(scenario.name).find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        bench.begin(scenario.name);
+        scenario.run(bench);
+        results.push_back(bench.end());
+
+        print_result(results.back());
+    }
+
+    if (!options.json_path.empty()) {
+        std::ofstream file(options.json_path);
+        if (!file) {
+            std::cerr << "Failed to open " << options.json_path << "!\n";
+            return EXIT_FAILURE;
+        }
+        file << to_json(results, options);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -23,7 +23,7 @@ class MyNode : public Node {
             vbox_container->add_child(button);
 
             auto callback = []() { Logger::info("Button triggered"); };
-            button->connect_signal("triggered", callback);
+            button->signal_triggered.connect(callback);
         }
 
         {
@@ -39,7 +39,7 @@ class MyNode : public Node {
             vbox_container->add_child(check_button);
 
             auto callback = [](bool toggled) { Logger::info("Button toggled"); };
-            check_button->connect_signal("toggled", callback);
+            check_button->signal_toggled.connect(callback);
         }
 
         {
@@ -13,6 +13,8 @@ class MyNode : public Node {
     float timer = 0;
 
     void custom_ready() override {
+        set_process(true);
+
         auto hbox_container = std::make_shared<HBoxContainer>();
         hbox_container->set_separation(8);
         hbox_container->set_position({100, 100});
@@ -13,6 +13,9 @@ public:
     std::weak_ptr<PopupMenu> menu_;
 
     void custom_ready() override {
+        // Open the menu on right clicks anywhere.
+        set_global_mouse_input(true);
+
         auto menu = std::make_shared<PopupMenu>();
         for (int i = 0; i < 20; i++) {
             menu->create_item("Item " + std::to_string(i));
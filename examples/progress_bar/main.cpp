@@ -6,6 +6,12 @@ using Pathfinder::Vec2;
 using Pathfinder::Vec3;
 
 class MyProgressBar : public ProgressBar {
+public:
+    MyProgressBar() {
+        set_process(true);
+    }
+
+private:
     void custom_update(double dt) override {
         float new_value = value + dt * 10.0f;
         if (new_value > max_value) {
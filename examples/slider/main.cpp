@@ -16,7 +16,7 @@ class MyNode : public NodeUi {
         add_child(slider1);
 
         auto callback1 = [](float value) { std::cout << value << std::endl; };
-        slider1->connect_signal("value_changed", callback1);
+        slider1->signal_value_changed.connect(callback1);
 
         auto slider2 = std::make_shared<Slider>();
         slider2->set_position({200, 300});
@@ -26,7 +26,7 @@ class MyNode : public NodeUi {
         add_child(slider2);
 
         auto callback2 = [](float value) { std::cout << value << std::endl; };
-        slider2->connect_signal("value_changed", callback2);
+        slider2->signal_value_changed.connect(callback2);
     }
 };
 
@@ -1,7 +1,10 @@
 #include "app.h"
 
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <thread>
 
 // clang-format off
 #ifdef PATHFINDER_USE_OPENGL
@@ -12,16 +15,40 @@
 #endif
 // clang-format on
 
+#include "render/render_target_pool.h"
 #include "resources/default_resource.h"
 #include "servers/engine.h"
 #include "servers/input_server.h"
+#include "servers/profiler.h"
 #include "servers/render_server.h"
+#include "servers/timer_server.h"
 #include "servers/vector_server.h"
 
 namespace vecgui {
 
+/// Longest sleep in low processor mode without windows, in seconds, since nothing can wake us up then.
+constexpr double MAX_HEADLESS_IDLE_SLEEP = 0.05;
+
+/// Block until input arrives or the next timer is due.
+void wait_for_events_or_deadline() {
+    auto timeout = TimerServer::get_singleton()->get_time_until_next_deadline();
+
+#ifndef __ANDROID__
+    if (RenderServer::get_singleton()->window_builder_) {
+        if (std::isinf(timeout)) {
+            glfwWaitEvents();
+        } else {
+            glfwWaitEventsTimeout(timeout);
+        }
+        return;
+    }
+#endif
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(std::min(timeout, MAX_HEADLESS_IDLE_SLEEP)));
+}
+
 #ifndef __ANDROID__
-App::App(Vec2I primary_window_size, const bool dark_mode, bool use_vulkan) {
+App::App(Vec2I primary_window_size, const bool dark_mode, bool use_vulkan, RenderLevel render_level) {
     // Set logger level.
     Logger::set_global_level(Logger::Level::Info);
     Logger::set_module_level("revector", Logger::Level::Info);
@@ -48,13 +75,18 @@ App::App(Vec2I primary_window_size, const bool dark_mode, bool use_vulkan) {
     vector_server->init(primary_window.lock()->get_physical_size(),
                         render_server->device_,
                         render_server->queue_,
-                        Pathfinder::RenderLevel::D3d9);
+                        resolve_render_level(render_level, render_server->device_, render_server->queue_));
 
     tree = std::make_unique<SceneTree>(primary_window_size);
 }
 
 #else
-App::App(ANativeWindow* native_window, void* asset_manager, Vec2I window_size, const bool dark_mode, bool use_vulkan) {
+App::App(ANativeWindow* native_window,
+         void* asset_manager,
+         Vec2I window_size,
+         const bool dark_mode,
+         bool use_vulkan,
+         RenderLevel render_level) {
     // Set logger level.
     Logger::set_global_level(Logger::Level::Info);
     Logger::set_module_level("revector", Logger::Level::Info);
@@ -89,12 +121,41 @@ App::App(ANativeWindow* native_window, void* asset_manager, Vec2I window_size, c
     vector_server->init(primary_window.lock()->get_physical_size(),
                         render_server->device_,
                         render_server->queue_,
-                        Pathfinder::RenderLevel::D3d9);
+                        resolve_render_level(render_level, render_server->device_, render_server->queue_));
 
     tree = std::make_unique<SceneTree>(window_size);
 }
 #endif
 
+std::unique_ptr<App> App::create_headless(Vec2I primary_window_size,
+                                          bool dark_mode,
+                                          const std::shared_ptr<Pathfinder::Device>& device,
+                                          const std::shared_ptr<Pathfinder::Queue>& queue,
+                                          RenderLevel render_level) {
+    Logger::set_global_level(Logger::Level::Info);
+    Logger::set_module_level("revector", Logger::Level::Info);
+
+    auto app = std::unique_ptr<App>(new App());
+    app->dark_mode_ = dark_mode;
+
+    DefaultResource::get_singleton()->init(dark_mode);
+
+    // No window builder means headless.
+    auto render_server = RenderServer::get_singleton();
+    render_server->window_builder_ = nullptr;
+    render_server->device_ = device;
+    render_server->queue_ = queue;
+
+    if (device) {
+        VectorServer::get_singleton()->init(
+            primary_window_size, device, queue, resolve_render_level(render_level, device, queue));
+    }
+
+    app->tree = std::make_unique<SceneTree>(primary_window_size);
+
+    return app;
+}
+
 App::~App() {
     // Clean up the scene tree.
     tree.reset();
@@ -102,6 +163,8 @@ App::~App() {
     VectorServer::get_singleton()->cleanup();
     Logger::verbose("Cleaned up VectorServer.", "revector");
 
+    RenderTargetPool::get_singleton()->clear();
+
     RenderServer::get_singleton()->destroy();
     Logger::verbose("Cleaned up RenderServer.", "revector");
 }
@@ -112,18 +175,27 @@ std::shared_ptr<Node> App::get_tree_root() const {
 
 void App::set_window_title(const std::string& title) {
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
     auto primary_window = render_server->window_builder_->get_window(0);
     primary_window.lock()->set_window_title(title);
 }
 
 void App::set_fullscreen(bool fullscreen) {
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
 
     render_server->window_builder_->set_fullscreen(fullscreen);
 }
 
 void App::set_custom_scaling_factor(float new_value) {
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
 
     render_server->window_builder_->set_dpi_scaling_factor(0, new_value);
 }
@@ -131,51 +203,107 @@ void App::set_custom_scaling_factor(float new_value) {
 float App::get_scaling_factor() const {
     auto render_server = RenderServer::get_singleton();
 
-    return render_server->window_builder_->get_dpi_scaling_factor(0);
+    return render_server->get_dpi_scaling_factor(0);
+}
+
+void App::set_low_processor_mode(bool enabled) {
+    low_processor_mode_ = enabled;
+}
+
+void App::set_fixed_dt(double dt) {
+    fixed_dt_ = dt;
+}
+
+SceneTree* App::get_tree() const {
+    return tree.get();
+}
+
+double App::get_process_dt() const {
+    if (fixed_dt_ > 0) {
+        return fixed_dt_;
+    }
+
+    return Engine::get_singleton()->get_dt();
 }
 
 void App::main_loop() {
     bool closing_app = false;
 
     while (!closing_app) {
-        RenderServer::get_singleton()->window_builder_->poll_events();
+        if (auto window_builder = RenderServer::get_singleton()->window_builder_) {
+            std::lock_guard window_lock(RenderServer::get_singleton()->window_mutex_);
+            window_builder->poll_events();
+        }
 
         // Engine processing.
         Engine::get_singleton()->tick();
 
         // Get frame time.
-        auto dt = Engine::get_singleton()->get_dt();
+        auto dt = get_process_dt();
 
         // Update the scene tree.
         tree->process(dt);
 
+        bool had_input = !InputServer::get_singleton()->input_queue.empty();
+
         InputServer::get_singleton()->clear_events();
 
         closing_app = tree->render();
+
+        InputServer::get_singleton()->finish_latency_frame();
+
+        VECGUI_PROFILE_END_FRAME();
+
+        if (low_processor_mode_ && !had_input && tree->is_idle()) {
+            // Events are handled while waiting, which may resize windows, so nothing may be presenting then.
+            tree->finish_rendering();
+
+            // Timers count the wait, frame times don't.
+            Engine::get_singleton()->begin_idle_wait();
+            wait_for_events_or_deadline();
+            TimerServer::get_singleton()->advance(Engine::get_singleton()->end_idle_wait());
+        }
     }
 
-    RenderServer::get_singleton()->window_builder_->stop_and_destroy_swapchains();
+    tree->finish_rendering();
+
+    if (auto window_builder = RenderServer::get_singleton()->window_builder_) {
+        window_builder->stop_and_destroy_swapchains();
+    }
 }
 
 bool App::single_run() {
-    RenderServer::get_singleton()->window_builder_->poll_events();
+    if (auto window_builder = RenderServer::get_singleton()->window_builder_) {
+        std::lock_guard window_lock(RenderServer::get_singleton()->window_mutex_);
+        window_builder->poll_events();
+    }
 
     // Engine processing.
     Engine::get_singleton()->tick();
 
     // Get frame time.
-    auto dt = Engine::get_singleton()->get_dt();
+    auto dt = get_process_dt();
 
     // Update the scene tree.
     tree->process(dt);
 
     InputServer::get_singleton()->clear_events();
 
-    return tree->render();
+    bool closing_app = tree->render();
+
+    InputServer::get_singleton()->finish_latency_frame();
+
+    VECGUI_PROFILE_END_FRAME();
+
+    return closing_app;
 }
 
 void App::single_run_cleanup() {
-    RenderServer::get_singleton()->window_builder_->stop_and_destroy_swapchains();
+    tree->finish_rendering();
+
+    if (auto window_builder = RenderServer::get_singleton()->window_builder_) {
+        window_builder->stop_and_destroy_swapchains();
+    }
 }
 
 } // namespace vecgui
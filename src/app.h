@@ -11,6 +11,7 @@
 #include "common/geometry.h"
 #include "nodes/scene_tree.h"
 #include "render/blit.h"
+#include "render/render_level.h"
 #include "servers/input_server.h"
 #include "servers/translation_server.h"
 
@@ -20,12 +21,30 @@ namespace vecgui {
 
 class App {
 public:
+    /// `render_level` is Pathfinder's, see RenderLevel. D3D11 and Auto fall back to D3D9 on OpenGL.
 #ifndef __ANDROID__
-    App(Vec2I primary_window_size, bool dark_mode, bool use_vulkan = true);
+    App(Vec2I primary_window_size,
+        bool dark_mode,
+        bool use_vulkan = true,
+        RenderLevel render_level = RenderLevel::D3d9);
 #else
-    App(ANativeWindow* native_window, void* asset_manager, Vec2I window_size, bool dark_mode, bool use_vulkan = true);
+    App(ANativeWindow* native_window,
+        void* asset_manager,
+        Vec2I window_size,
+        bool dark_mode,
+        bool use_vulkan = true,
+        RenderLevel render_level = RenderLevel::D3d9);
 #endif
 
+    /// Without a display, e.g. for tests and benchmarks on CI machines. Windows are virtual, with the given logical
+    /// size, and only receive synthetic input from InputServer::push_*(). Nothing is drawn unless a device is passed
+    /// (e.g. a software Vulkan one), in which case windows draw into offscreen textures.
+    static std::unique_ptr<App> create_headless(Vec2I primary_window_size,
+                                                bool dark_mode = false,
+                                                const std::shared_ptr<Pathfinder::Device>& device = nullptr,
+                                                const std::shared_ptr<Pathfinder::Queue>& queue = nullptr,
+                                                RenderLevel render_level = RenderLevel::D3d9);
+
     ~App();
 
     void main_loop();
@@ -44,10 +63,29 @@ public:
 
     float get_scaling_factor() const;
 
+    /// When enabled, the main loop waits through idle frames until input arrives or the next timer is due, instead
+    /// of spinning. Wake it from other threads with glfwPostEmptyEvent().
+    void set_low_processor_mode(bool enabled);
+
+    /// Advance every frame by this many seconds instead of the measured frame time, for reproducible runs.
+    /// Zero to measure again.
+    void set_fixed_dt(double dt);
+
+    SceneTree* get_tree() const;
+
 private:
+    App() = default;
+
+    /// The frame time to process with.
+    double get_process_dt() const;
+
     std::unique_ptr<SceneTree> tree;
 
     bool dark_mode_ = false;
+
+    bool low_processor_mode_ = false;
+
+    double fixed_dt_ = 0;
 };
 
 } // namespace vecgui
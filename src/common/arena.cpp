@@ -0,0 +1,80 @@
+#include "arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace vecgui {
+
+struct ChunkHeader {
+    /// Live allocations, plus one while the chunk is the current one of a thread.
+    std::atomic<uint32_t> references{1};
+};
+
+/// The chunk the calling thread is bumping through.
+struct ThreadArena {
+    ChunkHeader *chunk = nullptr;
+    size_t offset = 0;
+
+    ~ThreadArena();
+};
+
+thread_local ThreadArena thread_arena;
+
+bool bypasses_arena(size_t size, size_t alignment) {
+    return size > ARENA_MAX_ALLOCATION_SIZE || alignment > alignof(std::max_align_t);
+}
+
+size_t align_up(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+void release_chunk(ChunkHeader *chunk) {
+    if (chunk->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        chunk->~ChunkHeader();
+        ::operator delete(chunk, std::align_val_t(ARENA_CHUNK_SIZE));
+    }
+}
+
+ThreadArena::~ThreadArena() {
+    if (chunk) {
+        release_chunk(chunk);
+    }
+}
+
+void *arena_allocate(size_t size, size_t alignment) {
+    if (bypasses_arena(size, alignment)) {
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    auto &arena = thread_arena;
+
+    size_t offset = align_up(arena.offset, alignment);
+
+    if (arena.chunk == nullptr || offset + size > ARENA_CHUNK_SIZE) {
+        if (arena.chunk) {
+            release_chunk(arena.chunk);
+        }
+
+        auto memory = ::operator new(ARENA_CHUNK_SIZE, std::align_val_t(ARENA_CHUNK_SIZE));
+        arena.chunk = new (memory) ChunkHeader();
+        offset = align_up(sizeof(ChunkHeader), alignment);
+    }
+
+    arena.chunk->references.fetch_add(1, std::memory_order_relaxed);
+    arena.offset = offset + size;
+
+    return reinterpret_cast<std::byte *>(arena.chunk) + offset;
+}
+
+void arena_deallocate(void *pointer, size_t size, size_t alignment) {
+    if (bypasses_arena(size, alignment)) {
+        ::operator delete(pointer, std::align_val_t(alignment));
+        return;
+    }
+
+    auto address = reinterpret_cast<uintptr_t>(pointer) & ~(uintptr_t)(ARENA_CHUNK_SIZE - 1);
+    release_chunk(reinterpret_cast<ChunkHeader *>(address));
+}
+
+} // namespace vecgui
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace vecgui {
+
+/// Nodes are carved out from chunks of this size. Chunks are aligned to their size,
+/// so the chunk owning an allocation is found by masking its address.
+constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+/// Larger allocations bypass the arena.
+constexpr size_t ARENA_MAX_ALLOCATION_SIZE = ARENA_CHUNK_SIZE / 8;
+
+/// Bump-allocate from the current chunk of the calling thread. Consecutive allocations are adjacent,
+/// so a widget and the embedded children created by its constructor end up next to each other.
+/// Memory is not reused until everything allocated from a chunk has been freed, then the chunk is released.
+void *arena_allocate(size_t size, size_t alignment);
+
+/// Can be called from any thread.
+void arena_deallocate(void *pointer, size_t size, size_t alignment);
+
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &) {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(arena_allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, size_t n) {
+        arena_deallocate(pointer, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &) const {
+        return true;
+    }
+};
+
+/// Use this instead of std::make_shared to create nodes, which puts the node and its control block in the arena.
+template <typename T, typename... Args>
+std::shared_ptr<T> make_node(Args &&...args) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace vecgui
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <pathfinder/prelude.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "any_callable.h"
+
+namespace vecgui {
+
+/// A move-only callable. Callables up to `Capacity` bytes are stored inline, so typical lambdas
+/// capturing a few pointers don't allocate. Larger ones fall back to the heap.
+template <typename Signature, size_t Capacity = 32>
+class InplaceFunction;
+
+template <typename Ret, typename... Args, size_t Capacity>
+class InplaceFunction<Ret(Args...), Capacity> {
+public:
+    InplaceFunction() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceFunction>>>
+    InplaceFunction(F &&f) {
+        using Callable = std::decay_t<F>;
+
+        if constexpr (fits_inline<Callable>) {
+            new (storage_) Callable(std::forward<F>(f));
+            ops_ = &inline_ops<Callable>;
+        } else {
+            new (storage_) Callable *(new Callable(std::forward<F>(f)));
+            ops_ = &heap_ops<Callable>;
+        }
+    }
+
+    InplaceFunction(InplaceFunction &&other) noexcept {
+        move_from(other);
+    }
+
+    InplaceFunction &operator=(InplaceFunction &&other) noexcept {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    InplaceFunction(const InplaceFunction &) = delete;
+    InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+    ~InplaceFunction() {
+        reset();
+    }
+
+    Ret operator()(Args... args) const {
+        return ops_->invoke(storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const {
+        return ops_ != nullptr;
+    }
+
+private:
+    struct Ops {
+        Ret (*invoke)(void *storage, Args &&...args);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *storage);
+    };
+
+    template <typename C>
+    static constexpr bool fits_inline = sizeof(C) <= Capacity && alignof(C) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<C>;
+
+    template <typename C>
+    static constexpr Ops inline_ops = {
+        [](void *storage, Args &&...args) -> Ret {
+            return (*std::launder(reinterpret_cast<C *>(storage)))(std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) {
+            auto src_callable = std::launder(reinterpret_cast<C *>(src));
+            new (dst) C(std::move(*src_callable));
+            src_callable->~C();
+        },
+        [](void *storage) { std::launder(reinterpret_cast<C *>(storage))->~C(); },
+    };
+
+    template <typename C>
+    static constexpr Ops heap_ops = {
+        [](void *storage, Args &&...args) -> Ret {
+            return (**std::launder(reinterpret_cast<C **>(storage)))(std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) { new (dst) C *(*std::launder(reinterpret_cast<C **>(src))); },
+        [](void *storage) { delete *std::launder(reinterpret_cast<C **>(storage)); },
+    };
+
+    void move_from(InplaceFunction &other) {
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) mutable std::byte storage_[Capacity];
+
+    const Ops *ops_ = nullptr;
+};
+
+/// Returned by Signal::connect(). Zero is never a valid connection.
+using ConnectionId = uint32_t;
+
+/// A typed signal. Signals are plain members (e.g. `button->signal_triggered`),
+/// so connecting to a signal that doesn't exist or with mismatched arguments fails to compile.
+/// Emitting doesn't allocate or do any type checks.
+template <typename... Args>
+class Signal {
+public:
+    using Slot = InplaceFunction<void(Args...)>;
+
+    Signal() = default;
+
+    // Connections usually capture their owner, so don't carry them over to copies.
+    Signal(const Signal &) {
+    }
+
+    Signal &operator=(const Signal &) {
+        return *this;
+    }
+
+    template <typename F>
+    ConnectionId connect(F &&slot) {
+        auto id = next_id_++;
+
+        // Growing the slot vector while emitting would move the slot being called.
+        if (emit_depth_ > 0) {
+            pending_connections_.push_back({id, Slot(std::forward<F>(slot))});
+        } else {
+            connections_.push_back({id, Slot(std::forward<F>(slot))});
+        }
+
+        return id;
+    }
+
+    /// Safe to call from a slot of this signal.
+    void disconnect(ConnectionId id) {
+        if (id == 0) {
+            return;
+        }
+
+        if (emit_depth_ > 0) {
+            // Don't destroy a slot that may be running. Remove it after emitting.
+            for (auto &c : connections_) {
+                if (c.id == id) {
+                    c.id = 0;
+                    has_disconnected_ = true;
+                }
+            }
+            std::erase_if(pending_connections_, [id](const Connection &c) { return c.id == id; });
+        } else {
+            std::erase_if(connections_, [id](const Connection &c) { return c.id == id; });
+        }
+    }
+
+    void disconnect_all() {
+        if (emit_depth_ > 0) {
+            for (auto &c : connections_) {
+                c.id = 0;
+            }
+            has_disconnected_ = true;
+            pending_connections_.clear();
+        } else {
+            connections_.clear();
+        }
+    }
+
+    /// Slots connected during emission are called from the next emission on.
+    void emit(Args... args) {
+        emit_depth_++;
+
+        for (auto &c : connections_) {
+            if (c.id != 0) {
+                c.slot(args...);
+            }
+        }
+
+        emit_depth_--;
+
+        if (emit_depth_ == 0) {
+            if (has_disconnected_) {
+                std::erase_if(connections_, [](const Connection &c) { return c.id == 0; });
+                has_disconnected_ = false;
+            }
+            for (auto &c : pending_connections_) {
+                connections_.push_back(std::move(c));
+            }
+            pending_connections_.clear();
+        }
+    }
+
+    size_t get_connection_count() const {
+        size_t count = pending_connections_.size();
+        for (auto &c : connections_) {
+            count += c.id != 0;
+        }
+        return count;
+    }
+
+private:
+    struct Connection {
+        ConnectionId id;
+        Slot slot;
+    };
+
+    std::vector<Connection> connections_;
+
+    std::vector<Connection> pending_connections_;
+
+    ConnectionId next_id_ = 1;
+
+    uint32_t emit_depth_ = 0;
+
+    bool has_disconnected_ = false;
+};
+
+/// Connect a callback passed to the string-based connect_signal().
+/// Argument types are checked here once, instead of on every emit.
+template <typename... Args>
+ConnectionId connect_any_callable(Signal<Args...> &signal, const AnyCallable<void> &callback) {
+    auto function = std::any_cast<std::function<void(Args...)>>(&callback.m_any);
+    if (function == nullptr) {
+        Pathfinder::Logger::error("Mismatched signal argument types!", "revector");
+        return 0;
+    }
+
+    return signal.connect(*function);
+}
+
+} // namespace vecgui
@@ -0,0 +1,151 @@
+#include "hit_test_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "node.h"
+
+namespace vecgui {
+
+/// Roughly the size of a button.
+constexpr float HIT_TEST_CELL_SIZE = 64;
+
+/// Rows covering more cells, e.g. full-window containers and long scroll contents, are not put into cells.
+constexpr int64_t HIT_TEST_MAX_CELLS_PER_ROW = 64;
+
+uint64_t cell_key(int32_t x, int32_t y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+int32_t to_cell(float coordinate) {
+    return (int32_t)std::clamp(std::floor(coordinate / HIT_TEST_CELL_SIZE), -1e6f, 1e6f);
+}
+
+void HitTestGrid::rebuild(const NodeTable &table) {
+    table_ = &table;
+
+    auto row_count = table.size();
+
+    window_rows_.resize(row_count);
+    cell_ranges_.assign(row_count, {});
+    large_.assign(row_count, false);
+    windows_.clear();
+    global_rows_.clear();
+
+    for (uint32_t row = 0; row < row_count; row++) {
+        auto node = table.nodes[row];
+        auto parent = table.parents[row];
+
+        // Parents precede their children.
+        if (node->is_kind(NodeKind::Window) || parent == INVALID_ROW) {
+            window_rows_[row] = row;
+        } else {
+            window_rows_[row] = window_rows_[parent];
+        }
+
+        if (table.ui_nodes[row] == nullptr || node->is_kind(NodeKind::GlobalMouseInput)) {
+            global_rows_.push_back(row);
+        } else {
+            insert(row);
+        }
+    }
+}
+
+void HitTestGrid::update(NodeTable &table) {
+    for (uint32_t row = 0; row < table.size(); row++) {
+        if (!table.bounds_changed[row]) {
+            continue;
+        }
+        table.bounds_changed[row] = false;
+
+        if (table.ui_nodes[row] == nullptr || table.nodes[row]->is_kind(NodeKind::GlobalMouseInput)) {
+            continue;
+        }
+
+        remove(row);
+        insert(row);
+    }
+}
+
+void HitTestGrid::query(uint32_t row, Vec2F point, std::vector<uint32_t> &hit_rows) const {
+    auto window = windows_.find(window_rows_[row]);
+    if (window == windows_.end()) {
+        return;
+    }
+
+    auto test = [&](uint32_t r) {
+        auto min = table_->global_positions[r];
+        if (RectF(min, min + table_->sizes[r]).contains_point(point)) {
+            hit_rows.push_back(r);
+        }
+    };
+
+    auto cell = window->second.cells.find(cell_key(to_cell(point.x), to_cell(point.y)));
+    if (cell != window->second.cells.end()) {
+        std::ranges::for_each(cell->second, test);
+    }
+
+    std::ranges::for_each(window->second.large_rows, test);
+}
+
+HitTestGrid::CellRange HitTestGrid::get_cell_range(uint32_t row) const {
+    auto min = table_->global_positions[row];
+    auto max = min + table_->sizes[row];
+
+    return {to_cell(min.x), to_cell(min.y), to_cell(max.x), to_cell(max.y)};
+}
+
+void HitTestGrid::insert(uint32_t row) {
+    auto &window = windows_[window_rows_[row]];
+
+    auto range = get_cell_range(row);
+
+    auto cell_count = ((int64_t)range.max_x - range.min_x + 1) * ((int64_t)range.max_y - range.min_y + 1);
+
+    if (cell_count > HIT_TEST_MAX_CELLS_PER_ROW) {
+        window.large_rows.push_back(row);
+        large_[row] = true;
+        return;
+    }
+
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+        for (int32_t x = range.min_x; x <= range.max_x; x++) {
+            window.cells[cell_key(x, y)].push_back(row);
+        }
+    }
+
+    cell_ranges_[row] = range;
+}
+
+void HitTestGrid::remove(uint32_t row) {
+    auto &window = windows_[window_rows_[row]];
+
+    auto swap_erase = [row](std::vector<uint32_t> &rows) {
+        auto it = std::ranges::find(rows, row);
+        if (it != rows.end()) {
+            *it = rows.back();
+            rows.pop_back();
+        }
+    };
+
+    if (large_[row]) {
+        swap_erase(window.large_rows);
+        large_[row] = false;
+        return;
+    }
+
+    auto range = cell_ranges_[row];
+
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+        for (int32_t x = range.min_x; x <= range.max_x; x++) {
+            auto cell = window.cells.find(cell_key(x, y));
+            if (cell != window.cells.end()) {
+                swap_erase(cell->second);
+            }
+        }
+    }
+
+    cell_ranges_[row] = {};
+}
+
+} // namespace vecgui
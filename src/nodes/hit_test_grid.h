@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/geometry.h"
+#include "node_table.h"
+
+namespace vecgui {
+
+/// Uniform grid over the global rects of UI nodes, one per window, so mouse events can be routed
+/// to the nodes under the cursor instead of to every node of the window.
+class HitTestGrid {
+public:
+    /// Index all UI rows of a table. Call after the table has been rebuilt.
+    void rebuild(const NodeTable &table);
+
+    /// Re-index rows whose global rect changed since the last call, see NodeTable::bounds_changed.
+    void update(NodeTable &table);
+
+    /// Append rows of the window containing `row` whose rect contains the point, in no particular order.
+    void query(uint32_t row, Vec2F point, std::vector<uint32_t> &hit_rows) const;
+
+    /// Non-UI nodes and nodes receiving global mouse input, which are not indexed by position.
+    const std::vector<uint32_t> &get_global_rows() const {
+        return global_rows_;
+    }
+
+private:
+    struct CellRange {
+        int32_t min_x = 0;
+        int32_t min_y = 0;
+        int32_t max_x = -1;
+        int32_t max_y = -1;
+    };
+
+    struct WindowCells {
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+
+        /// Rows spanning too many cells, tested one by one.
+        std::vector<uint32_t> large_rows;
+    };
+
+    CellRange get_cell_range(uint32_t row) const;
+
+    void insert(uint32_t row);
+
+    void remove(uint32_t row);
+
+    const NodeTable *table_ = nullptr;
+
+    /// Per row, the row of the window it belongs to.
+    std::vector<uint32_t> window_rows_;
+
+    /// Per row, the cells it has been inserted into.
+    std::vector<CellRange> cell_ranges_;
+
+    /// Per row, if it is in WindowCells::large_rows instead.
+    std::vector<uint8_t> large_;
+
+    std::unordered_map<uint32_t, WindowCells> windows_;
+
+    std::vector<uint32_t> global_rows_;
+};
+
+} // namespace vecgui
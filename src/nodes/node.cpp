@@ -5,6 +5,8 @@
 
 #include "../servers/render_server.h"
 #include "proxy_window.h"
+#include "scene_tree.h"
+#include "ui/container/cached_layer.h"
 #include "ui/node_ui.h"
 
 namespace vecgui {
@@ -22,6 +24,9 @@ const char *NodeNames[] = {
     "VBoxContainer",
     "ScrollContainer",
     "TabContainer",
+    "CollapseContainer",
+    "SplitContainer",
+    "CachedLayer",
 
     "Button",
     "MenuButton",
@@ -29,6 +34,8 @@ const char *NodeNames[] = {
     "CheckButton",
     "RadioButton",
 
+    "Slider",
+
     "Label",
     "TextEdit",
     "SpinBox",
@@ -37,12 +44,15 @@ const char *NodeNames[] = {
     "Tree",
     "ProgressBar",
     "PopupMenu",
+    "FrameStatsOverlay",
 
     "NotInstantiable",
 
     "Max",
 };
 
+static_assert(std::size(NodeNames) == (size_t)NodeType::Max + 1, "NodeNames is out of sync with NodeType!");
+
 std::string get_node_type_name(NodeType type) {
     return NodeNames[(uint32_t)type];
 }
@@ -97,7 +107,7 @@ void dfs_postorder_rtl_traversal_skip_priority_node_and_invisible(Node *node, st
         return;
     }
     // Skip ProxyWindow and all its children.
-    if (typeid(*node) == typeid(ProxyWindow)) {
+    if (node->is_kind(NodeKind::Window)) {
         return;
     }
 
@@ -110,6 +120,22 @@ void dfs_postorder_rtl_traversal_skip_priority_node_and_invisible(Node *node, st
     ordered_nodes.push_back(node);
 }
 
+/// A newly attached child has to pick up the global transform of its new parent.
+void queue_attached_child_retransform(Node *child) {
+    if (child->is_ui_node()) {
+        static_cast<NodeUi *>(child)->queue_retransform();
+    } else {
+        child->propagate_transform_pending();
+    }
+}
+
+Node::~Node() {
+    // Normally nodes leave the tree before being destroyed, but don't leave dangling pointers behind if not.
+    if (tree_) {
+        tree_->unregister_node(this);
+    }
+}
+
 void Node::ready() {
     if (ready_) {
         return;
@@ -175,12 +201,17 @@ void Node::add_child(const std::shared_ptr<Node> &new_child) {
 
     // Set self as the parent of the new node.
     new_child->parent = this;
-    new_child->tree_ = tree_;
 
     children.push_back(new_child);
 
+    if (tree_) {
+        new_child->propagate_enter_tree(tree_);
+    }
+
+    queue_attached_child_retransform(new_child.get());
+
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
@@ -198,12 +229,17 @@ void Node::add_child_at_index(const std::shared_ptr<Node> &new_child, uint32_t i
 
     // Set self as the parent of the new node.
     new_child->parent = this;
-    new_child->tree_ = tree_;
 
     children.insert(children.begin() + index, new_child);
 
+    if (tree_) {
+        new_child->propagate_enter_tree(tree_);
+    }
+
+    queue_attached_child_retransform(new_child.get());
+
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
@@ -215,12 +251,17 @@ void Node::add_embedded_child(const std::shared_ptr<Node> &new_child) {
 
     // Set self as the parent of the new node.
     new_child->parent = this;
-    new_child->tree_ = tree_;
 
     embedded_children.push_back(new_child);
 
+    if (tree_) {
+        new_child->propagate_enter_tree(tree_);
+    }
+
+    queue_attached_child_retransform(new_child.get());
+
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
@@ -236,25 +277,25 @@ void Node::remove_child(size_t index) {
     if (index < 0 || index >= children.size()) {
         return;
     }
+    children[index]->propagate_exit_tree();
     children.erase(children.begin() + index);
 
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
 void Node::remove_all_children() {
+    for (auto &child : children) {
+        child->propagate_exit_tree();
+    }
     children.clear();
 
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
-bool Node::is_ui_node() const {
-    return false;
-}
-
 void Node::set_visibility(bool visible) {
     if (visible_ == visible) {
         return;
@@ -262,8 +303,10 @@ void Node::set_visibility(bool visible) {
 
     visible_ = visible;
 
+    queue_redraw();
+
     if (this->is_ui_node()) {
-        dynamic_cast<NodeUi *>(this)->queue_relayout();
+        static_cast<NodeUi *>(this)->queue_relayout();
     }
 }
 
@@ -290,7 +333,11 @@ bool Node::get_global_visibility() const {
 uint8_t Node::get_window_index() const {
     if (type == NodeType::Window) {
         auto sub_window_node = (ProxyWindow *)this;
-        return sub_window_node->get_raw_window()->window_index;
+        return sub_window_node->window_index_;
+    }
+
+    if (tree_) {
+        return tree_window_index_;
     }
 
     if (parent) {
@@ -307,9 +354,7 @@ void Node::when_parent_size_changed(Vec2F new_size) {
 }
 
 void Node::when_subtree_changed() {
-    for (auto &callback : subtree_changed_callbacks) {
-        callback();
-    }
+    signal_subtree_changed.emit();
 
     // Branch->root signal propagation.
     if (parent) {
@@ -319,7 +364,7 @@ void Node::when_subtree_changed() {
 
 void Node::connect_signal(const std::string &signal, const AnyCallable<void> &callback) {
     if (signal == "subtree_changed") {
-        subtree_changed_callbacks.push_back(callback);
+        connect_any_callable(signal_subtree_changed, callback);
     }
 }
 
@@ -331,4 +376,141 @@ SceneTree *Node::get_tree() const {
     return tree_;
 }
 
+void Node::set_process(bool enabled) {
+    if (process_enabled_ == enabled) {
+        return;
+    }
+
+    process_enabled_ = enabled;
+
+    if (tree_) {
+        if (enabled) {
+            tree_->register_process(this);
+        } else {
+            tree_->unregister_process(this);
+        }
+    }
+}
+
+bool Node::is_processing() const {
+    return process_enabled_;
+}
+
+void Node::set_global_mouse_input(bool enabled) {
+    set_kind(NodeKind::GlobalMouseInput, enabled);
+
+    // The hit-test grid is rebuilt along with the node table.
+    queue_node_table_rebuild();
+}
+
+void Node::set_draw_overflow(bool enabled) {
+    set_kind(NodeKind::DrawOverflow, enabled);
+
+    // Overflowing subtrees are found when the node table is rebuilt.
+    queue_node_table_rebuild();
+}
+
+void Node::queue_node_table_rebuild() {
+    if (tree_) {
+        tree_->node_table_dirty = true;
+    }
+}
+
+/// See Node::defer_ancestor_walks().
+thread_local DeferredAncestorWalks *deferred_ancestor_walks = nullptr;
+
+void Node::queue_redraw() {
+    if (tree_) {
+        tree_->queue_window_redraw(tree_window_index_);
+    }
+
+    // A layer is invalidated along with every enclosing one, so we can stop at the first invalid one.
+    for (auto node = this; node->inside_cached_layer_; ) {
+        if (deferred_ancestor_walks && node == deferred_ancestor_walks->root) {
+            deferred_ancestor_walks->redraws.push_back(node);
+            return;
+        }
+
+        node = node->parent;
+        if (node->is_kind(NodeKind::CachedLayer) && !static_cast<CachedLayer *>(node)->invalidate()) {
+            return;
+        }
+    }
+}
+
+void Node::propagate_enter_tree(SceneTree *tree) {
+    tree_ = tree;
+    inside_cached_layer_ = parent && (parent->is_kind(NodeKind::CachedLayer) || parent->inside_cached_layer_);
+    if (type == NodeType::Window) {
+        tree_window_index_ = static_cast<ProxyWindow *>(this)->window_index_;
+    } else if (parent) {
+        tree_window_index_ = parent->tree_window_index_;
+    }
+    tree->register_node(this);
+
+    enter_tree();
+
+    for (auto &child : get_all_children()) {
+        child->propagate_enter_tree(tree);
+    }
+}
+
+void Node::propagate_exit_tree() {
+    if (tree_ == nullptr) {
+        return;
+    }
+
+    // The layer no longer draws this node.
+    queue_redraw();
+
+    exit_tree();
+
+    tree_->unregister_node(this);
+    tree_ = nullptr;
+
+    for (auto &child : get_all_children()) {
+        child->propagate_exit_tree();
+    }
+}
+
+void Node::propagate_transform_pending() {
+    transform_pending_ = true;
+
+    // Ancestors of a pending node are always pending, so we can stop early.
+    for (Node *node = this; node->parent && !node->parent->transform_pending_; node = node->parent) {
+        if (deferred_ancestor_walks && node == deferred_ancestor_walks->root) {
+            deferred_ancestor_walks->transform_pending.push_back(node);
+            return;
+        }
+
+        node->parent->transform_pending_ = true;
+    }
+}
+
+DeferredAncestorWalks *Node::defer_ancestor_walks(DeferredAncestorWalks *walks) {
+    auto previous = deferred_ancestor_walks;
+    deferred_ancestor_walks = walks;
+    return previous;
+}
+
+DeferredAncestorWalks *Node::get_deferred_ancestor_walks() {
+    return deferred_ancestor_walks;
+}
+
+void Node::replay_ancestor_walks(const DeferredAncestorWalks &walks) {
+    for (auto node : walks.transform_pending) {
+        // Clear it, or the walk would stop right away.
+        node->transform_pending_ = false;
+        node->propagate_transform_pending();
+    }
+
+    for (auto node : walks.redraws) {
+        node->queue_redraw();
+    }
+
+    for (auto node : walks.relayouts) {
+        node->queue_parent_relayout();
+    }
+}
+
 } // namespace vecgui
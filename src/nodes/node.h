@@ -4,6 +4,8 @@
 #include <vector>
 
 #include "../common/any_callable.h"
+#include "../common/arena.h"
+#include "../common/signal.h"
 #include "../common/utils.h"
 #include "../servers/engine.h"
 #include "../servers/input_server.h"
@@ -27,6 +29,7 @@ enum class NodeType {
     TabContainer,
     CollapseContainer,
     SplitContainer,
+    CachedLayer,
 
     Button,
     MenuButton,
@@ -44,6 +47,7 @@ enum class NodeType {
     Tree,
     ProgressBar,
     PopupMenu,
+    FrameStatsOverlay,
 
     NotInstantiable,
 
@@ -52,7 +56,43 @@ enum class NodeType {
 
 std::string get_node_type_name(NodeType type);
 
+/// Cached node properties, so hot loops don't need RTTI. A node can have several kinds.
+enum class NodeKind : uint32_t {
+    Ui = 1 << 0,
+    Window = 1 << 1,
+    Popup = 1 << 2,
+    Container = 1 << 3,
+    /// Changes inside don't affect the minimum size, so relayout requests don't propagate further up.
+    LayoutBoundary = 1 << 4,
+    /// Receives mouse events anywhere in its window, not only under the cursor.
+    GlobalMouseInput = 1 << 5,
+    /// Children are only visible inside its rect, so the draw pass culls them against it.
+    ClipsChildren = 1 << 6,
+    /// Drawn outside of its parent's rect, so its ancestors are never culled as a whole.
+    DrawOverflow = 1 << 7,
+    /// Draws its subtree from a cached texture, see CachedLayer.
+    CachedLayer = 1 << 8,
+};
+
 class SceneTree;
+class Node;
+class NodeUi;
+
+/// Ancestor walks recorded instead of done, while subtrees are processed in parallel. Only the part of a walk that
+/// leaves the subtree of `root` is recorded, as it would write to nodes shared by several workers. See
+/// Node::defer_ancestor_walks().
+struct DeferredAncestorWalks {
+    /// Root of the subtree the current thread works on. Walks are done right away up to it.
+    Node *root = nullptr;
+    /// Roots whose ancestors have to be marked transform-pending.
+    std::vector<Node *> transform_pending;
+    /// Roots whose enclosing cached layers have to be invalidated.
+    std::vector<Node *> redraws;
+    /// Roots whose parent has to be told about their relayout.
+    std::vector<NodeUi *> relayouts;
+};
+
+constexpr uint32_t INVALID_NODE_ID = UINT32_MAX;
 
 /// Position-independent, window-independent base node.
 class Node {
@@ -61,7 +101,7 @@ class Node {
 public:
     std::string name;
 
-    virtual ~Node() = default;
+    virtual ~Node();
 
     /// Called at first time entering the tree.
     virtual void ready();
@@ -79,6 +119,14 @@ public:
     virtual void post_draw_children() {
     }
 
+    /// Called when this node is attached to a scene tree, directly or along with an ancestor.
+    virtual void enter_tree() {
+    }
+
+    /// Called when this node is detached from its scene tree, directly or along with an ancestor.
+    virtual void exit_tree() {
+    }
+
     virtual void custom_ready() {
     }
 
@@ -112,7 +160,13 @@ public:
 
     void remove_all_children();
 
-    virtual bool is_ui_node() const;
+    bool is_ui_node() const {
+        return is_kind(NodeKind::Ui);
+    }
+
+    bool is_kind(NodeKind kind) const {
+        return kinds_ & (uint32_t)kind;
+    }
 
     virtual void set_visibility(bool visible);
 
@@ -133,17 +187,93 @@ public:
      */
     void when_subtree_changed();
 
+    /// Connect a callback by signal name. Prefer connecting to the typed signal members directly,
+    /// e.g. `button->signal_triggered.connect(...)`.
     virtual void connect_signal(const std::string &signal, const AnyCallable<void> &callback);
 
+    /// Emitted when the subtree structure of this node or of any descendant changed.
+    Signal<> signal_subtree_changed;
+
     SceneTree *get_tree() const;
 
+    /// Stable while the node is inside a scene tree, INVALID_NODE_ID otherwise.
+    /// IDs of removed nodes are reused.
+    uint32_t get_id() const {
+        return id_;
+    }
+
+    /// Opt in to (or out of) update() every frame. Nodes that don't process cost nothing per frame.
+    /// Disabled by default, so custom nodes overriding custom_update() have to call set_process(true).
+    void set_process(bool enabled);
+
+    bool is_processing() const;
+
+    /// UI nodes only receive mouse events under the cursor, or while hovered, focused or pressed.
+    /// Enable this for nodes reacting to mouse input anywhere in the window. Non-UI nodes always do.
+    void set_global_mouse_input(bool enabled);
+
+    /// UI nodes outside the window or an enclosing scroll container are culled along with their subtree.
+    /// Enable this for nodes drawn outside of their parent's rect, e.g. with a negative position.
+    void set_draw_overflow(bool enabled);
+
+    /// Have the window and the cached layers this node is drawn into re-render it. Layout, transform, visibility,
+    /// hover and focus already do this, and built-in widgets do it when input or animation changes their state. Call
+    /// it when something else changes the way a node draws, e.g. in custom_input() or custom_update().
+    void queue_redraw();
+
+    /// If any UI node in this subtree needs to recalculate its global transform.
+    bool is_transform_pending() const {
+        return transform_pending_;
+    }
+
+    void clear_transform_pending() {
+        transform_pending_ = false;
+    }
+
+    /// Mark this node and its ancestors, so the transform system will visit this subtree.
+    void propagate_transform_pending();
+
+    /// Until called again, have the current thread record walks above `walks->root` in `walks` instead of doing
+    /// them. Pass nullptr to stop. Returns the previous buffer, so calls can nest.
+    static DeferredAncestorWalks *defer_ancestor_walks(DeferredAncestorWalks *walks);
+
+    /// Do recorded walks, or record them into the current buffer of the thread, if any.
+    static void replay_ancestor_walks(const DeferredAncestorWalks &walks);
+
 protected:
     NodeType type = NodeType::Node;
 
+    /// Set by constructors, see NodeKind.
+    uint32_t kinds_ = 0;
+
+    void set_kind(NodeKind kind, bool enabled) {
+        if (enabled) {
+            kinds_ |= (uint32_t)kind;
+        } else {
+            kinds_ &= ~(uint32_t)kind;
+        }
+    }
+
+    /// The buffer walks up to ancestors are recorded into on the current thread, if any. See defer_ancestor_walks().
+    static DeferredAncestorWalks *get_deferred_ancestor_walks();
+
+    /// Rebuild the node table of the tree before it's used next, e.g. to find overflowing subtrees again.
+    void queue_node_table_rebuild();
+
     bool ready_ = false;
 
     bool visible_ = true;
 
+    bool transform_pending_ = true;
+
+    bool process_enabled_ = false;
+
+    /// If an ancestor is a CachedLayer. Only valid inside a scene tree.
+    bool inside_cached_layer_ = false;
+
+    /// Of the enclosing window, see get_window_index(). Only valid inside a scene tree.
+    uint8_t tree_window_index_ = 0;
+
     std::vector<std::shared_ptr<Node>> children;
 
     std::vector<std::shared_ptr<Node>> embedded_children;
@@ -152,10 +282,17 @@ protected:
     // Also, we must initialize it to null.
     Node *parent{};
 
-    SceneTree *tree_;
+    SceneTree *tree_{};
+
+    uint32_t id_ = INVALID_NODE_ID;
+
+
+private:
+    /// Called when this subtree is attached to a node that is inside a scene tree.
+    void propagate_enter_tree(SceneTree *tree);
 
-    // Called when subtree structure changes.
-    std::vector<AnyCallable<void>> subtree_changed_callbacks;
+    /// Called when this subtree is detached from the scene tree.
+    void propagate_exit_tree();
 };
 
 /// Perform a depth-first-search preorder traversal from left-to-right.
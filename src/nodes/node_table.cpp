@@ -0,0 +1,94 @@
+#include "node_table.h"
+
+#include "node.h"
+#include "ui/node_ui.h"
+
+namespace vecgui {
+
+void NodeTable::build(Node *root) {
+    nodes.clear();
+    ui_nodes.clear();
+    parents.clear();
+    subtree_ends.clear();
+    subtree_overflows.clear();
+
+    if (root) {
+        push_subtree(root, INVALID_ROW);
+    }
+
+    auto row_count = nodes.size();
+
+    sizes.resize(row_count);
+    global_positions.resize(row_count);
+    retransformed.assign(row_count, false);
+    bounds_changed.assign(row_count, false);
+
+    for (uint32_t row = 0; row < row_count; row++) {
+        sync_row(row);
+    }
+}
+
+void NodeTable::push_subtree(Node *node, uint32_t parent_row) {
+    auto row = (uint32_t)nodes.size();
+
+    nodes.push_back(node);
+    ui_nodes.push_back(node->is_ui_node() ? static_cast<NodeUi *>(node) : nullptr);
+    parents.push_back(parent_row);
+    subtree_ends.push_back(0);
+    // Rotated and scaled nodes may leave their parent's rect.
+    subtree_overflows.push_back(node->is_kind(NodeKind::DrawOverflow) ||
+                                (ui_nodes.back() && ui_nodes.back()->has_rotation_or_scale()));
+
+    for (auto &child : node->get_all_children()) {
+        auto child_row = (uint32_t)nodes.size();
+        push_subtree(child.get(), row);
+        subtree_overflows[row] |= subtree_overflows[child_row];
+    }
+
+    subtree_ends[row] = nodes.size();
+}
+
+void NodeTable::map_ids(uint32_t id_count) {
+    rows_by_id.assign(id_count, INVALID_ROW);
+
+    for (uint32_t row = 0; row < nodes.size(); row++) {
+        auto id = nodes[row]->get_id();
+        if (id < id_count) {
+            rows_by_id[id] = row;
+        }
+    }
+}
+
+void NodeTable::sync_row(uint32_t row) {
+    if (auto ui_node = ui_nodes[row]) {
+        auto bounds = ui_node->get_global_bounds();
+        auto size = Vec2F(bounds.width(), bounds.height());
+        auto global_position = Vec2F(bounds.left, bounds.top);
+
+        if (sizes[row] != size || global_positions[row] != global_position) {
+            bounds_changed[row] = true;
+        }
+
+        sizes[row] = size;
+        global_positions[row] = global_position;
+    }
+}
+
+uint32_t NodeTable::get_row(const Node *node) const {
+    auto id = node->get_id();
+    if (id >= rows_by_id.size()) {
+        return INVALID_ROW;
+    }
+
+    return rows_by_id[id];
+}
+
+std::vector<uint32_t> NodeTable::get_child_rows(uint32_t row) const {
+    std::vector<uint32_t> child_rows;
+    for (uint32_t c = row + 1; c < subtree_ends[row]; c = subtree_ends[c]) {
+        child_rows.push_back(c);
+    }
+    return child_rows;
+}
+
+} // namespace vecgui
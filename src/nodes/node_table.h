@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/geometry.h"
+
+namespace vecgui {
+
+class Node;
+class NodeUi;
+
+constexpr uint32_t INVALID_ROW = UINT32_MAX;
+
+/// Structure-of-arrays mirror of a node tree in preorder, so per-frame systems can iterate linearly
+/// instead of chasing child pointers. The descendants of row i occupy rows [i + 1, subtree_ends[i]).
+struct NodeTable {
+    // Structure. Only rebuilt when nodes are added or removed.
+    std::vector<Node *> nodes;
+    /// Null for non-UI nodes, which saves a kind check per visit.
+    std::vector<NodeUi *> ui_nodes;
+    /// INVALID_ROW for the root.
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> subtree_ends;
+    /// If any row of the subtree, this one included, is drawn outside of its parent's rect. See NodeKind::DrawOverflow.
+    std::vector<uint8_t> subtree_overflows;
+
+    // Global rects, read by culling and hit testing. Refreshed by sync_row(), which is called for every node
+    // the layout and transform passes touch. Zero for non-UI nodes. Axis-aligned bounds for rotated and scaled nodes,
+    // see NodeUi::get_global_bounds().
+    std::vector<Vec2F> sizes;
+    std::vector<Vec2F> global_positions;
+
+    /// Scratch column of the transform pass.
+    std::vector<uint8_t> retransformed;
+
+    /// Set by sync_row() when the global rect of a row changed. Cleared by the hit-test grid.
+    std::vector<uint8_t> bounds_changed;
+
+    /// Indexed by node ID, for tables owned by a scene tree.
+    std::vector<uint32_t> rows_by_id;
+
+    void build(Node *root);
+
+    /// Map the node IDs of all rows, see Node::get_id().
+    void map_ids(uint32_t id_count);
+
+    void sync_row(uint32_t row);
+
+    uint32_t get_row(const Node *node) const;
+
+    std::vector<uint32_t> get_child_rows(uint32_t row) const;
+
+    uint32_t size() const {
+        return nodes.size();
+    }
+
+private:
+    void push_subtree(Node *node, uint32_t parent_row);
+};
+
+} // namespace vecgui
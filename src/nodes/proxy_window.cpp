@@ -1,43 +1,73 @@
 #include "proxy_window.h"
 
 #include "../common/geometry.h"
+#include "../render/render_target_pool.h"
+#include "../servers/profiler.h"
 #include "../servers/render_server.h"
 #include "../servers/vector_server.h"
 
 namespace vecgui {
 
+/// Behind everything drawn, same as the clear color of the blit pass.
+
 ProxyWindow::ProxyWindow(const Vec2I size, const int window_index) {
     type = NodeType::Window;
+    set_kind(NodeKind::Window, true);
 
     size_ = size;
 
     auto render_server = RenderServer::get_singleton();
 
-    if (window_index > -1) {
-        window_index_ = window_index;
-    } else {
-        window_index_ = render_server->window_builder_->create_window(size_, "Window");
+    if (render_server->is_headless()) {
+        // Draws offscreen into the vector target, if there's a device at all.
+        window_index_ = render_server->create_headless_window(size_, window_index);
+        return;
     }
 
-    auto window = render_server->window_builder_->get_window(window_index_).lock();
+    Pathfinder::TextureFormat surface_format;
 
-    auto input_server = InputServer::get_singleton();
-    input_server->initialize_window_callbacks(window_index_);
+    {
+        // Other windows may be presented on the render thread meanwhile.
+        std::lock_guard window_lock(render_server->window_mutex_);
+
+        if (window_index > -1) {
+            window_index_ = window_index;
+        } else {
+            window_index_ = render_server->window_builder_->create_window(size_, "Window");
+        }
 
-    auto swap_chain_ = window->get_swap_chain(render_server->device_);
+        auto window = render_server->window_builder_->get_window(window_index_).lock();
 
-    blit_ = std::make_shared<Blit>(render_server->device_, render_server->queue_, swap_chain_->get_surface_format());
+        auto input_server = InputServer::get_singleton();
+        input_server->initialize_window_callbacks(window_index_);
 
-    vector_target_ =
-        render_server->device_->create_texture({size_, Pathfinder::TextureFormat::Rgba8Unorm}, "dst texture");
+        surface_format = window->get_swap_chain(render_server->device_)->get_surface_format();
+    }
+
+    std::lock_guard gpu_lock(render_server->gpu_mutex_);
+
+    blit_ = std::make_shared<Blit>(render_server->device_, render_server->queue_, surface_format);
+
+    // The vector target is created along with the first frame, if it's needed.
+}
+
+ProxyWindow::~ProxyWindow() {
+    RenderTargetPool::get_singleton()->release(vector_target_);
+    VectorServer::get_singleton()->release_window(window_index_);
 }
 
 Vec2I ProxyWindow::get_size() const {
     return size_;
 }
 
-void ProxyWindow::update(double dt) {
+void ProxyWindow::sync_visibility() {
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
+
+    std::lock_guard window_lock(render_server->window_mutex_);
+
     auto window = render_server->window_builder_->get_window(window_index_).lock();
 
     // Closing a window just hides it.
@@ -48,91 +78,176 @@ void ProxyWindow::update(double dt) {
     }
 }
 
-void ProxyWindow::pre_draw_propagation() {
+bool ProxyWindow::is_redraw_needed() const {
+    if (drawn_scale_ == 0) {
+        return true;
+    }
+
+    auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return render_server->get_window_logical_size(window_index_) != drawn_size_;
+    }
+
+    auto window = render_server->window_builder_->get_window(window_index_).lock();
+
+    return window->get_dpi_scaling_factor() != drawn_scale_ || window->get_physical_size() != drawn_size_;
+}
+
+bool ProxyWindow::pre_draw_propagation() {
     if (!visible_) {
-        return;
+        return false;
     }
 
     auto render_server = RenderServer::get_singleton();
     auto vector_server = VectorServer::get_singleton();
 
-    auto window = render_server->window_builder_->get_window(window_index_).lock();
+    auto render_target_pool = RenderTargetPool::get_singleton();
 
-    // Set DPI.
-    vector_server->set_global_scale(window->get_dpi_scaling_factor());
+    if (render_server->is_headless()) {
+        auto size = render_server->get_window_logical_size(window_index_);
+        if (size.is_any_zero()) {
+            return false;
+        }
 
-    auto physical_size = window->get_physical_size();
+        vector_target_ = render_target_pool->fit(vector_target_, size);
+        drawn_size_ = size;
 
-    if (physical_size != vector_target_->get_size()) {
-        if (!physical_size.is_any_zero()) {
-            // Texture & canvas should use the physical size.
-            auto physical_size = window->get_physical_size();
+        drawn_scale_ = 1;
+        vector_server->set_global_scale(drawn_scale_);
+        vector_server->select_window(window_index_, size, vector_target_);
+        return true;
+    }
 
-            vector_target_ = render_server->device_->create_texture(
-                {physical_size, Pathfinder::TextureFormat::Rgba8Unorm}, "dst texture");
+    auto window = render_server->window_builder_->get_window(window_index_).lock();
 
-            vector_server->set_canvas_size(physical_size);
+    auto physical_size = window->get_physical_size();
 
-            std::ostringstream ss;
-            ss << "Vector target of the primary window resized to " << physical_size;
-            Logger::info(ss.str(), "revector");
-        }
+    if (physical_size.is_any_zero()) {
+        return false;
     }
 
-    vector_server->set_dst_texture(vector_target_);
+    // The canvas should use the physical size. While resizing, the target mostly stays the same.
+    vector_target_ = render_target_pool->fit(vector_target_, physical_size);
+
+    drawn_size_ = physical_size;
+
+    // Set DPI.
+    drawn_scale_ = window->get_dpi_scaling_factor();
+    vector_server->set_global_scale(drawn_scale_);
 
-    // temp_draw_data.previous_scene = vector_server->get_canvas()->take_scene();
+    vector_server->select_window(window_index_, physical_size, vector_target_);
+
+    return true;
 }
 
 void ProxyWindow::post_draw_propagation() {
-    auto render_server = RenderServer::get_singleton();
-    auto vector_server = VectorServer::get_singleton();
+    auto input_server = InputServer::get_singleton();
 
-    auto window = render_server->window_builder_->get_window(window_index_).lock();
-    auto swap_chain_ = window->get_swap_chain(render_server->device_);
+    present(
+        [](const std::shared_ptr<Pathfinder::Texture> &dst_texture) {
+            auto vector_server = VectorServer::get_singleton();
+            vector_server->set_dst_texture(dst_texture);
+            vector_server->submit_and_clear();
+        },
+        vector_target_,
+        drawn_size_,
+        [input_server](LatencyStage stage) { input_server->mark_latency_stage(stage); });
+}
+
+void ProxyWindow::present_frame(const std::shared_ptr<Pathfinder::Scene> &scene,
+                                const std::shared_ptr<Pathfinder::Texture> &vector_target,
+                                Vec2I size,
+                                LatencyFrame &latency) {
+    // Drawn on the main thread already.
+    present(
+        [&](const std::shared_ptr<Pathfinder::Texture> &dst_texture) {
+            VectorServer::get_singleton()->draw_scene(window_index_, scene, dst_texture);
+        },
+        vector_target,
+        size,
+        [&latency](LatencyStage stage) {
+            if (stage != LatencyStage::Drawn) {
+                latency.stage_times[(size_t)stage] = std::chrono::steady_clock::now();
+            }
+        });
+}
 
-    // Acquire next swap chain image.
-    if (!swap_chain_->acquire_image()) {
+void ProxyWindow::present(const std::function<void(const std::shared_ptr<Pathfinder::Texture> &)> &draw_canvas,
+                          const std::shared_ptr<Pathfinder::Texture> &vector_target,
+                          Vec2I size,
+                          const std::function<void(LatencyStage)> &mark_latency_stage) {
+    auto render_server = RenderServer::get_singleton();
+
+    // Offscreen, the vector target is the result.
+    if (render_server->is_headless()) {
+        mark_latency_stage(LatencyStage::Drawn);
+        draw_canvas(vector_target);
+        mark_latency_stage(LatencyStage::Submitted);
+        mark_latency_stage(LatencyStage::Presented);
         return;
     }
 
-    vector_server->submit_and_clear();
+    std::shared_ptr<Pathfinder::SwapChain> swap_chain_;
+    std::shared_ptr<Pathfinder::Texture> surface_texture;
 
-    // vector_server->get_canvas()->set_scene(temp_draw_data.previous_scene);
+    {
+        // Acquiring recreates the swap chain after a resize, which must not overlap event polling.
+        std::lock_guard window_lock(render_server->window_mutex_);
 
-    auto encoder = render_server->device_->create_command_encoder("Window main encoder");
+        auto window = render_server->window_builder_->get_window(window_index_).lock();
+        swap_chain_ = window->get_swap_chain(render_server->device_);
 
-    auto surface_texture = swap_chain_->get_surface_texture();
+        // Acquire next swap chain image.
+        if (!swap_chain_->acquire_image()) {
+            return;
+        }
+
+        surface_texture = swap_chain_->get_surface_texture();
+    }
+
+    mark_latency_stage(LatencyStage::Drawn);
+
+    draw_canvas(vector_target);
+
+    mark_latency_stage(LatencyStage::Submitted);
+
+    auto encoder = render_server->device_->create_command_encoder("Window main encoder");
 
-    // Swap chain render pass.
+    // Swap chain render pass, which reads the vector target and writes every pixel of the swap chain image.
     {
-        encoder->begin_render_pass(swap_chain_->get_render_pass(), surface_texture, ColorF(0.2, 0.2, 0.2, 1.0));
+        VECGUI_PROFILE_ZONE("Blit");
 
-        encoder->set_viewport({{0, 0}, window->get_physical_size()});
+        blit_->set_texture(vector_target);
 
-        blit_->set_texture(vector_target_);
+        encoder->begin_render_pass(swap_chain_->get_render_pass(), surface_texture, ColorF(0.2, 0.2, 0.2, 1.0));
 
-        // Draw canvas to screen.
-        blit_->draw(encoder);
+        // Draw canvas to screen. The target may be larger than the frame, see RenderTargetPool.
+        blit_->draw(encoder, surface_texture->get_size());
 
         encoder->end_render_pass();
+
+        // Four bytes per pixel read from the vector target and written to the swap chain image.
+        VECGUI_PROFILE_COUNT_N(NodeType::Window, BlitBytes, size.area() * 8);
     }
 
-    swap_chain_->submit(encoder);
+    {
+        VECGUI_PROFILE_ZONE("Present");
+
+        std::lock_guard window_lock(render_server->window_mutex_);
 
-    swap_chain_->present();
-}
+        swap_chain_->submit(encoder);
 
-void ProxyWindow::set_visibility(bool visible) {
-    if (visible_ == visible) {
-        return;
+        swap_chain_->present();
     }
 
-    visible_ = visible;
+    mark_latency_stage(LatencyStage::Presented);
 }
 
 std::shared_ptr<Pathfinder::Window> ProxyWindow::get_raw_window() const {
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return nullptr;
+    }
 
     auto window = render_server->window_builder_->get_window(window_index_).lock();
 
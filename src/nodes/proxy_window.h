@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include "../common/geometry.h"
@@ -11,22 +12,39 @@ class Blit;
 
 class ProxyWindow : public Node {
     friend class SceneTree;
+    friend class Node;
 
 public:
     ProxyWindow(Vec2I size, int window_index);
 
-    void update(double dt) override;
+    ~ProxyWindow() override;
 
-    void pre_draw_propagation();
+    /// Show or hide the native window. Called every frame before drawing.
+    void sync_visibility();
 
+    /// If the last drawn frame is outdated regardless of the nodes, e.g. because the window was resized.
+    bool is_redraw_needed() const;
+
+    /// Select the canvas of this window. False if there's nothing to draw into, e.g. while minimized.
+    bool pre_draw_propagation();
+
+    /// Draw what was recorded since pre_draw_propagation() and present it.
     void post_draw_propagation();
 
-    Vec2I get_size() const;
+    /// Like post_draw_propagation(), for a scene taken from the canvas of this window, drawn at a physical `size`.
+    /// Safe to call on the render thread with RenderServer::gpu_mutex_ held, as it only touches the native window
+    /// under RenderServer::window_mutex_. The submitted and presented stages are recorded into `latency`.
+    void present_frame(const std::shared_ptr<Pathfinder::Scene> &scene,
+                       const std::shared_ptr<Pathfinder::Texture> &vector_target,
+                       Vec2I size,
+                       LatencyFrame &latency);
 
-    void set_visibility(bool visible) override;
+    Vec2I get_size() const;
 
+    /// Null in headless mode.
     std::shared_ptr<Pathfinder::Window> get_raw_window() const;
 
+    /// May be larger than the window, see RenderTargetPool.
     std::shared_ptr<Pathfinder::Texture> get_vector_target() const {
         return vector_target_;
     }
@@ -44,10 +62,18 @@ protected:
 
     std::shared_ptr<Pathfinder::Texture> vector_target_;
 
+    /// DPI scale of the last drawn frame. Zero before the first one.
+    float drawn_scale_ = 0;
+
+    /// Physical size of the last drawn frame.
+    Vec2I drawn_size_;
+
 private:
-    struct {
-        std::shared_ptr<Pathfinder::Scene> previous_scene;
-    } temp_draw_data;
+    /// Acquire a swap chain image, draw into the vector target with `draw_canvas`, and blit that to the image.
+    void present(const std::function<void(const std::shared_ptr<Pathfinder::Texture> &dst_texture)> &draw_canvas,
+                 const std::shared_ptr<Pathfinder::Texture> &vector_target,
+                 Vec2I size,
+                 const std::function<void(LatencyStage)> &mark_latency_stage);
 };
 
 } // namespace vecgui
@@ -4,17 +4,161 @@
 #include <execution>
 #include <future>
 
+#include "../servers/profiler.h"
 #include "../servers/render_server.h"
+#include "../servers/timer_server.h"
+#include "../servers/vector_server.h"
 #include "proxy_window.h"
 
 namespace vecgui {
 
 SceneTree::SceneTree(Vec2I primary_window_size) {
-    auto primary_window = std::make_shared<ProxyWindow>(primary_window_size, 0);
+    auto primary_window = make_node<ProxyWindow>(primary_window_size, 0);
     primary_window->name = "Primary window";
 
     root = primary_window;
-    root->tree_ = this;
+    root->propagate_enter_tree(this);
+}
+
+SceneTree::~SceneTree() {
+    set_pipelined_rendering(false);
+
+    root->propagate_exit_tree();
+}
+
+void SceneTree::register_node(Node* node) {
+    if (free_node_ids.empty()) {
+        node->id_ = node_id_count++;
+    } else {
+        node->id_ = free_node_ids.back();
+        free_node_ids.pop_back();
+    }
+
+    if (!node->ready_) {
+        pending_ready_nodes.push_back(node);
+    }
+    if (node->is_kind(NodeKind::Window)) {
+        queue_window_redraw(node->tree_window_index_);
+    }
+    if (node->process_enabled_) {
+        register_process(node);
+    }
+
+    node_table_dirty = true;
+}
+
+void SceneTree::register_process(Node* node) {
+    processing_nodes.push_back(node);
+}
+
+void SceneTree::unregister_process(Node* node) {
+    // Don't erase, as we may be in the middle of the update loop.
+    std::ranges::replace(processing_nodes, node, nullptr);
+}
+
+void SceneTree::unregister_node(Node* node) {
+    // The frame in flight may still present it.
+    if (node->is_kind(NodeKind::Window)) {
+        finish_rendering();
+    }
+
+    if (!node->ready_) {
+        std::ranges::replace(pending_ready_nodes, node, nullptr);
+    }
+    if (node->process_enabled_) {
+        unregister_process(node);
+    }
+
+    std::ranges::replace(mouse_tracked_nodes, node, nullptr);
+    std::ranges::replace(mouse_captured_nodes, node, nullptr);
+    for (auto& target : mouse_targets) {
+        if (target.node == node) {
+            target.node = nullptr;
+        }
+    }
+
+    free_node_ids.push_back(node->id_);
+    node->id_ = INVALID_NODE_ID;
+
+    node_table_dirty = true;
+}
+
+void SceneTree::update_node_table() {
+    if (!node_table_dirty) {
+        return;
+    }
+
+    node_table.build(root.get());
+    node_table.map_ids(node_id_count);
+
+    node_table_dirty = false;
+    hit_test_grid_dirty = true;
+}
+
+void SceneTree::update_hit_test_grid() {
+    update_node_table();
+
+    if (hit_test_grid_dirty) {
+        hit_test_grid.rebuild(node_table);
+        mouse_routes.assign(node_table.size(), {});
+        hit_test_grid_dirty = false;
+    } else {
+        hit_test_grid.update(node_table);
+    }
+}
+
+const NodeTable& SceneTree::get_node_table() const {
+    return node_table;
+}
+
+uint32_t SceneTree::get_culled_node_count() const {
+    return culled_node_count;
+}
+
+uint32_t SceneTree::get_drawn_window_count() const {
+    return drawn_window_count;
+}
+
+void SceneTree::set_redraw_all_windows(bool enabled) {
+    redraw_all_windows = enabled;
+}
+
+static_assert(MAX_WINDOW_COUNT > UINT8_MAX, "Window redraw flags must cover every window index!");
+
+void SceneTree::queue_window_redraw(uint8_t window_index) {
+    // Most calls find the flag already set, so avoid dirtying the cache line.
+    if (!window_redraw_queued[window_index].load(std::memory_order_relaxed)) {
+        window_redraw_queued[window_index].store(true, std::memory_order_relaxed);
+    }
+}
+
+/// Call `func` on the child rows of `row` in parallel. Each call must only touch the subtree of its child. Walks
+/// leaving that subtree, like relayout or redraw requests reaching `row`, are recorded per child and done on the
+/// calling thread afterwards, in child order. Walks within it are done right away, as in a serial pass.
+template <typename F>
+void parallel_for_each_child(const NodeTable& table, uint32_t row, F&& func) {
+    auto child_rows = table.get_child_rows(row);
+
+    std::vector<DeferredAncestorWalks> walks(child_rows.size());
+    for (size_t i = 0; i < child_rows.size(); i++) {
+        walks[i].root = table.nodes[child_rows[i]];
+    }
+
+    auto deferred_func = [&](const uint32_t& child_row) {
+        auto previous = Node::defer_ancestor_walks(&walks[&child_row - child_rows.data()]);
+        func(child_row);
+        Node::defer_ancestor_walks(previous);
+    };
+
+#if defined(__APPLE__) || defined(__ANDROID__)
+    std::ranges::for_each(child_rows, deferred_func);
+#else
+    std::for_each(std::execution::par, child_rows.begin(), child_rows.end(), deferred_func);
+#endif
+
+    for (auto& item_walks : walks) {
+        Node::replay_ancestor_walks(item_walks);
+    }
 }
 
 void propagate_input(Node* node, InputEvent& event) {
@@ -23,15 +167,15 @@ void propagate_input(Node* node, InputEvent& event) {
     }
 
     for (auto& child : node->get_all_children_reversed()) {
-        if (typeid(*child) == typeid(ProxyWindow) || !node->get_visibility()) {
+        if (child->is_kind(NodeKind::Window) || !node->get_visibility()) {
             continue;
         }
 
         // Do not propagate out-of-bounds mouse input events if they are explicitly ignored.
         if (node->is_ui_node()) {
-            auto ui_node = dynamic_cast<NodeUi*>(node);
+            auto ui_node = static_cast<NodeUi *>(node);
 
-            if (ui_node->get_node_type() == NodeType::ScrollContainer) {
+            if (ui_node->ignore_mouse_input_outside_rect()) {
                 // Intercept out-of-scope mouse input events.
                 auto global_position = ui_node->get_global_position();
 
@@ -63,126 +207,503 @@ void propagate_input(Node* node, InputEvent& event) {
     node->input(event);
 }
 
-void input_system(Node* root, std::vector<InputEvent>& input_queue) {
-    std::vector<Node*> priority_nodes;
-    {
-        std::vector<Node*> nodes;
-        dfs_postorder_rtl_traversal(root, nodes);
+/// Call the node's draw(), counting the canvas paths it records.
+void draw_node(Node* node) {
+#ifdef VECGUI_PROFILER
+    auto vector_server = VectorServer::get_singleton();
+    auto path_count = vector_server->get_path_count();
 
-        for (auto& node : nodes) {
-            if (typeid(*node) == typeid(ProxyWindow) || typeid(*node) == typeid(PopupMenu)) {
-                priority_nodes.push_back(node);
+    node->draw();
+
+    VECGUI_PROFILE_COUNT_N(node->get_node_type(), CanvasPaths, vector_server->get_path_count() - path_count);
+#else
+    node->draw();
+#endif
+}
+
+/// Rotated and scaled nodes draw their subtree as if they weren't, with the view transformed around them.
+class ViewTransformScope {
+public:
+    explicit ViewTransformScope(Node* node) {
+        if (node->is_ui_node()) {
+            auto ui_node = static_cast<NodeUi*>(node);
+            pushed_ = ui_node->has_rotation_or_scale();
+            if (pushed_) {
+                VectorServer::get_singleton()->push_view_transform(ui_node->get_view_transform());
             }
         }
     }
 
-    for (auto& p_node : priority_nodes) {
-        if (!p_node->get_visibility()) {
+    ~ViewTransformScope() {
+        if (pushed_) {
+            VectorServer::get_singleton()->pop_transform();
+        }
+    }
+
+private:
+    bool pushed_ = false;
+};
+
+void propagate_draw(Node* node) {
+    VECGUI_PROFILE_COUNT(node->get_node_type(), DrawCalls);
+
+    ViewTransformScope view_transform_scope(node);
+
+    draw_node(node);
+
+    node->pre_draw_children();
+
+    for (auto& child : node->get_all_children()) {
+        if (!node->get_visibility()) {
+            continue;
+        }
+        // Don't propagate to ProxyWindows/PopupMenus as we'll handle them differently.
+        if (child->is_kind(NodeKind::Window)) {
+            continue;
+        }
+        if (child->is_kind(NodeKind::Popup)) {
             continue;
         }
 
-        for (auto& event : input_queue) {
-            if (event.window_index != p_node->get_window_index()) {
+        propagate_draw(child.get());
+    }
+
+    node->post_draw_children();
+}
+
+void SceneTree::draw_subtree(uint32_t row, RectF clip) {
+    auto node = node_table.nodes[row];
+
+    RectF bounds;
+
+    if (node_table.ui_nodes[row]) {
+        auto global_position = node_table.global_positions[row];
+        bounds = RectF(global_position, global_position + node_table.sizes[row]);
+
+        if (!node_table.subtree_overflows[row] && !bounds.intersects(clip)) {
+            VECGUI_PROFILE_COUNT(node->get_node_type(), Culled);
+            culled_node_count++;
+            return;
+        }
+
+        if (node->is_kind(NodeKind::ClipsChildren)) {
+            clip = clip.intersection(bounds);
+        }
+    }
+
+    VECGUI_PROFILE_COUNT(node->get_node_type(), DrawCalls);
+
+    ViewTransformScope view_transform_scope(node);
+
+    draw_node(node);
+
+    node->pre_draw_children();
+
+    if (node->is_kind(NodeKind::CachedLayer)) {
+        auto layer = static_cast<CachedLayer*>(node);
+
+        if (!layer->should_draw_children()) {
+            node->post_draw_children();
+            return;
+        }
+
+        // The cache has to be complete, whatever is visible right now.
+        if (layer->is_recording()) {
+            clip = bounds;
+        }
+    }
+
+    if (node->get_visibility()) {
+        for (uint32_t child = row + 1; child < node_table.subtree_ends[row]; child = node_table.subtree_ends[child]) {
+            // Don't propagate to ProxyWindows/PopupMenus as we'll handle them differently.
+            auto child_node = node_table.nodes[child];
+            if (child_node->is_kind(NodeKind::Window) || child_node->is_kind(NodeKind::Popup)) {
                 continue;
             }
 
-            propagate_input(p_node, event);
+            draw_subtree(child, clip);
         }
     }
+
+    node->post_draw_children();
+}
+
+void calc_minimum_size_if_dirty(const NodeTable& table, uint32_t row) {
+    auto ui_node = table.ui_nodes[row];
+    if (ui_node && ui_node->is_layout_dirty()) {
+        ui_node->calc_minimum_size();
+    }
 }
 
-void propagate_transform(NodeUi* node, Vec2F parent_global_transform) {
-    if (node == nullptr) {
+void adjust_layout_if_dirty(NodeTable& table, uint32_t row) {
+    auto ui_node = table.ui_nodes[row];
+    if (ui_node && ui_node->is_layout_dirty()) {
+        VECGUI_PROFILE_COUNT(ui_node->get_node_type(), Relayouts);
+
+        ui_node->apply_anchor();
+        ui_node->adjust_layout();
+        ui_node->clear_layout_dirty();
+        table.sync_row(row);
+    }
+}
+
+/// Bottom-up. A node's minimum size only depends on its children, so sibling subtrees are independent.
+void calc_minimum_size_subtree(const NodeTable& table, uint32_t row, uint32_t grain_size) {
+    uint32_t end = table.subtree_ends[row];
+
+    if (end - row <= grain_size) {
+        // Reversed preorder visits every child before its parent.
+        for (uint32_t i = end; i > row; i--) {
+            calc_minimum_size_if_dirty(table, i - 1);
+        }
         return;
     }
 
-    node->calc_global_position(parent_global_transform);
+    parallel_for_each_child(table, row, [&](uint32_t c) { calc_minimum_size_subtree(table, c, grain_size); });
 
-    for (auto& child : node->get_all_children()) {
-        if (child->is_ui_node()) {
-            auto ui_child = dynamic_cast<NodeUi*>(child.get());
-            propagate_transform(ui_child, node->get_global_position());
+    calc_minimum_size_if_dirty(table, row);
+}
+
+/// Top-down. Once a node has arranged its children, it never touches anything outside of its own subtree again,
+/// apart from the walks up the tree deferred by parallel_for_each_child(), so sibling subtrees are independent.
+void layout_subtree(NodeTable& table, uint32_t row, uint32_t grain_size) {
+    uint32_t end = table.subtree_ends[row];
+
+    if (end - row <= grain_size) {
+        for (uint32_t i = row; i < end; i++) {
+            adjust_layout_if_dirty(table, i);
         }
+        return;
     }
+
+    adjust_layout_if_dirty(table, row);
+
+    parallel_for_each_child(table, row, [&](uint32_t c) { layout_subtree(table, c, grain_size); });
 }
 
-void transform_system(Node* root) {
-    if (root == nullptr) {
+/// Recalculate the global transform of a row if it or any ancestor changed.
+/// Returns false if the subtree of the row can be skipped.
+bool transform_row(NodeTable& table, uint32_t row) {
+    auto node = table.nodes[row];
+    auto ui_node = table.ui_nodes[row];
+
+    // UI nodes only inherit transforms from UI parents.
+    auto parent = table.parents[row];
+    auto ui_parent = parent != INVALID_ROW ? table.ui_nodes[parent] : nullptr;
+    bool force = ui_parent && table.retransformed[parent];
+
+    table.retransformed[row] = false;
+
+    if (ui_node && (force || ui_node->is_transform_dirty())) {
+        ui_node->calc_global_transform(ui_parent);
+        table.sync_row(row);
+        table.retransformed[row] = true;
+    }
+
+    if (!table.retransformed[row] && !node->is_transform_pending()) {
+        return false;
+    }
+
+    node->clear_transform_pending();
+
+    return true;
+}
+
+/// Only visit the pending part of the tree. Once a node is recalculated, its whole UI subtree has to follow.
+void transform_subtree(NodeTable& table, uint32_t row, uint32_t grain_size) {
+    uint32_t end = table.subtree_ends[row];
+
+    if (end - row <= grain_size) {
+        for (uint32_t i = row; i < end;) {
+            i = transform_row(table, i) ? i + 1 : table.subtree_ends[i];
+        }
         return;
     }
 
-    // Collect all orphan UI nodes.
-    std::vector<Node*> nodes;
-    std::vector<NodeUi*> orphan_ui_nodes;
-    dfs_preorder_ltr_traversal(root, nodes);
-    for (auto& node : nodes) {
-        if (node->is_ui_node()) {
-            // Has no parent or no UI parent.
-            if (node->get_parent() == nullptr || !node->get_parent()->is_ui_node()) {
-                auto ui_node = dynamic_cast<NodeUi*>(node);
-                orphan_ui_nodes.push_back(ui_node);
+    if (!transform_row(table, row)) {
+        return;
+    }
+
+    parallel_for_each_child(table, row, [&](uint32_t c) { transform_subtree(table, c, grain_size); });
+}
+
+void calc_minimum_size(const NodeTable& table, uint32_t grain_size) {
+    VECGUI_PROFILE_ZONE("Calc minimum size");
+
+    if (table.size() > 0) {
+        calc_minimum_size_subtree(table, 0, grain_size);
+    }
+}
+
+void layout_system(NodeTable& table, uint32_t grain_size) {
+    VECGUI_PROFILE_ZONE("Layout");
+
+    if (table.size() > 0) {
+        layout_subtree(table, 0, grain_size);
+    }
+}
+
+void transform_system(NodeTable& table, uint32_t grain_size) {
+    VECGUI_PROFILE_ZONE("Transform");
+
+    if (table.size() > 0) {
+        transform_subtree(table, 0, grain_size);
+    }
+}
+
+void calc_minimum_size(Node* root, uint32_t grain_size) {
+    NodeTable table;
+    table.build(root);
+    calc_minimum_size(table, grain_size);
+}
+
+void layout_system(Node* root, uint32_t grain_size) {
+    NodeTable table;
+    table.build(root);
+    layout_system(table, grain_size);
+}
+
+void transform_system(Node* root, uint32_t grain_size) {
+    NodeTable table;
+    table.build(root);
+    transform_system(table, grain_size);
+}
+
+bool is_mouse_event(const InputEvent& event) {
+    return event.type == InputEventType::MouseMotion || event.type == InputEventType::MouseButton ||
+           event.type == InputEventType::MouseScroll;
+}
+
+void SceneTree::input_system(std::vector<InputEvent>& input_queue) {
+    VECGUI_PROFILE_ZONE("Input");
+
+    update_node_table();
+
+    // Reversed preorder is the same as right-to-left postorder, i.e. front-to-back.
+    std::vector<Node*> priority_nodes;
+    for (uint32_t row = node_table.size(); row > 0; row--) {
+        auto node = node_table.nodes[row - 1];
+        if (node->is_kind(NodeKind::Window) || node->is_kind(NodeKind::Popup)) {
+            priority_nodes.push_back(node);
+        }
+    }
+
+    if (std::ranges::any_of(input_queue, is_mouse_event)) {
+        update_hit_test_grid();
+    }
+
+    for (auto& p_node : priority_nodes) {
+        if (!p_node->get_visibility()) {
+            continue;
+        }
+
+        for (auto& event : input_queue) {
+            if (event.window_index != p_node->get_window_index()) {
+                continue;
+            }
+
+            if (!is_mouse_event(event)) {
+                propagate_input(p_node, event);
+                continue;
+            }
+
+            // Nodes may have been added or removed by previous events.
+            if (node_table_dirty) {
+                update_hit_test_grid();
+            }
+
+            auto root_row = node_table.get_row(p_node);
+            if (root_row != INVALID_ROW) {
+                dispatch_mouse_event(root_row, event);
             }
         }
     }
+}
+
+/// Mouse positions of an event as a rotated or scaled node tests them, see NodeUi::window_to_global().
+InputEvent map_mouse_event(const InputEvent& event, const NodeUi* ui_node) {
+    InputEvent mapped_event = event; // Copy
+
+    if (event.type == InputEventType::MouseMotion) {
+        auto& args = mapped_event.args.mouse_motion;
+        auto position = ui_node->window_to_global(args.position);
+        args.relative = position - ui_node->window_to_global(args.position - args.relative);
+        args.position = position;
+    } else if (event.type == InputEventType::MouseButton) {
+        auto& args = mapped_event.args.mouse_button;
+        args.position = ui_node->window_to_global(args.position);
+    }
 
-// There's no transform dependency between orphan UI nodes.
-#if defined(__APPLE__) || defined(__ANDROID__)
-    std::ranges::for_each(orphan_ui_nodes, [](NodeUi* ui_node) { propagate_transform(ui_node, Vec2F{}); });
-#else
-    std::for_each(std::execution::par, orphan_ui_nodes.begin(), orphan_ui_nodes.end(), [](NodeUi* ui_node) {
-        propagate_transform(ui_node, Vec2F{});
-    });
-#endif
+    return mapped_event;
 }
 
-void propagate_draw(Node* node) {
-    node->draw();
+enum MouseRouteState : uint8_t {
+    Skip,
+    Deliver,
+    // Only tracked, captured and global nodes get a dummy event, others would ignore it anyway.
+    DeliverClipped,
+};
+
+void SceneTree::dispatch_mouse_event(uint32_t root_row, InputEvent& event) {
+    auto cursor_position = InputServer::get_singleton()->cursor_position;
+
+    Vec2F position = cursor_position;
+    if (event.type == InputEventType::MouseMotion) {
+        position = event.args.mouse_motion.position;
+    } else if (event.type == InputEventType::MouseButton) {
+        position = event.args.mouse_button.position;
+    }
 
-    node->pre_draw_children();
+    auto root_end = node_table.subtree_ends[root_row];
+    auto stamp = ++mouse_route_stamp;
 
-    for (auto& child : node->get_all_children()) {
-        if (!node->get_visibility()) {
-            continue;
+    mouse_candidate_rows.clear();
+    hit_test_grid.query(root_row, position, mouse_candidate_rows);
+    auto hit_count = mouse_candidate_rows.size();
+
+    auto add_special = [&](uint32_t row) {
+        if (row != INVALID_ROW) {
+            mouse_candidate_rows.push_back(row);
+            mouse_routes[row].special = true;
+            mouse_routes[row].stamp = stamp;
+            mouse_routes[row].state = Skip;
+            mouse_routes[row].child_state = Skip;
         }
-        // Don't propagate to ProxyWindows/PopupMenus as we'll handle them differently.
-        if (typeid(*child) == typeid(ProxyWindow)) {
-            continue;
+    };
+
+    std::ranges::for_each(hit_test_grid.get_global_rows(), add_special);
+    for (auto node : mouse_tracked_nodes) {
+        if (node) {
+            add_special(node_table.get_row(node));
         }
-        if (typeid(*child) == typeid(PopupMenu)) {
+    }
+    for (auto node : mouse_captured_nodes) {
+        if (node) {
+            add_special(node_table.get_row(node));
+        }
+    }
+    for (size_t i = 0; i < hit_count; i++) {
+        auto& route = mouse_routes[mouse_candidate_rows[i]];
+        if (route.stamp != stamp) {
+            route = {stamp, Skip, Skip, false};
+        }
+    }
+
+    // Unresolved rows have the stamp but no state yet. Resolved rows are remembered by this.
+    auto resolved_stamp = ++mouse_route_stamp;
+
+    // Out-of-bounds mouse events are intercepted by ScrollContainers, see propagate_input().
+    auto clips = [&](uint32_t row) {
+        auto ui_node = node_table.ui_nodes[row];
+        if (ui_node == nullptr || !ui_node->ignore_mouse_input_outside_rect()) {
+            return false;
+        }
+        auto global_position = ui_node->get_global_position();
+        return !RectF(global_position, global_position + ui_node->get_size())
+                    .contains_point(ui_node->window_to_global(cursor_position));
+    };
+
+    auto resolve = [&](uint32_t row, uint8_t parent_child_state) {
+        auto& route = mouse_routes[row];
+        auto node = node_table.nodes[row];
+
+        if (parent_child_state == Skip || !node->get_visibility() ||
+            (row != root_row && node->is_kind(NodeKind::Window))) {
+            route.state = Skip;
+            route.child_state = Skip;
+        } else {
+            route.state = parent_child_state;
+            route.child_state = route.state == DeliverClipped || clips(row) ? DeliverClipped : Deliver;
+        }
+
+        bool special = route.special && route.stamp == stamp;
+        route.stamp = resolved_stamp;
+        route.special = special;
+
+        if (route.state == Deliver || (route.state == DeliverClipped && special)) {
+            mouse_targets.push_back({row, node, route.state == DeliverClipped});
+        }
+    };
+
+    mouse_targets.clear();
+
+    // The root has been checked for visibility by the caller.
+    if (mouse_routes[root_row].stamp != resolved_stamp) {
+        resolve(root_row, Deliver);
+    }
+
+    for (auto candidate : mouse_candidate_rows) {
+        if (candidate < root_row || candidate >= root_end) {
             continue;
         }
 
-        propagate_draw(child.get());
+        // Walk up until a resolved ancestor, then resolve top-down.
+        mouse_route_chain.clear();
+        for (auto row = candidate; mouse_routes[row].stamp != resolved_stamp; row = node_table.parents[row]) {
+            mouse_route_chain.push_back(row);
+        }
+
+        for (auto it = mouse_route_chain.rbegin(); it != mouse_route_chain.rend(); ++it) {
+            resolve(*it, mouse_routes[node_table.parents[*it]].child_state);
+        }
     }
 
-    node->post_draw_children();
-}
+    std::ranges::sort(mouse_targets, std::greater{}, &MouseTarget::row);
 
-void calc_minimum_size(Node* root) {
-    std::vector<Node*> descendants;
-    dfs_postorder_ltr_traversal(root, descendants);
-    for (auto& node : descendants) {
-        if (node->is_ui_node()) {
-            auto ui_node = dynamic_cast<NodeUi*>(node);
-            if (ui_node->is_layout_dirty()) {
-                ui_node->calc_minimum_size();
-            }
+    for (size_t i = 0; i < mouse_targets.size(); i++) {
+        auto target = mouse_targets[i];
+        if (target.node == nullptr || !target.node->get_visibility()) {
+            continue;
+        }
+
+        if (target.clipped) {
+            InputEvent dummy_event = event; // Copy
+            dummy_event.consumed = false;
+            dummy_event.type = InputEventType::MouseMotion;
+            dummy_event.args.mouse_motion.position = {-99999, -99999};
+            target.node->input(dummy_event);
+        } else if (target.node->is_ui_node() && static_cast<NodeUi*>(target.node)->is_transformed()) {
+            auto mapped_event = map_mouse_event(event, static_cast<NodeUi*>(target.node));
+            target.node->input(mapped_event);
+            event.consumed = mapped_event.consumed;
+        } else {
+            target.node->input(event);
         }
     }
-}
 
-void layout_system(Node* root) {
-    std::vector<Node*> nodes;
-    dfs_preorder_ltr_traversal(root, nodes);
-    for (auto& node : nodes) {
+    // Delivered nodes are reevaluated, others keep their state.
+    auto delivered = [&](Node* node) {
+        auto row = node_table.get_row(node);
+        return row != INVALID_ROW && mouse_routes[row].stamp == resolved_stamp && mouse_routes[row].state != Skip;
+    };
+
+    std::erase_if(mouse_tracked_nodes, [&](Node* node) { return node == nullptr || delivered(node); });
+
+    bool released = event.type == InputEventType::MouseButton && !event.args.mouse_button.pressed;
+    bool pressed = event.type == InputEventType::MouseButton && event.args.mouse_button.pressed;
+
+    if (released) {
+        std::erase_if(mouse_captured_nodes, [&](Node* node) { return node == nullptr || delivered(node); });
+    } else {
+        std::erase(mouse_captured_nodes, nullptr);
+    }
+
+    for (auto& target : mouse_targets) {
+        auto node = target.node;
+        if (node == nullptr) {
+            continue;
+        }
+
         if (node->is_ui_node()) {
-            auto ui_node = dynamic_cast<NodeUi*>(node);
-            if (ui_node->is_layout_dirty()) {
-                ui_node->apply_anchor();
-                ui_node->adjust_layout();
-                ui_node->clear_layout_dirty();
+            auto ui_node = static_cast<NodeUi*>(node);
+            if (ui_node->is_hovered() || ui_node->has_focus()) {
+                mouse_tracked_nodes.push_back(node);
             }
         }
+
+        if (pressed && std::ranges::find(mouse_captured_nodes, node) == mouse_captured_nodes.end()) {
+            mouse_captured_nodes.push_back(node);
+        }
     }
 }
 
@@ -191,91 +712,267 @@ void SceneTree::process(double dt) {
         return;
     }
 
-    if (get_primary_window().lock()->get_resize_flag()) {
+    auto primary_window = get_primary_window().lock();
+    if (primary_window && primary_window->get_resize_flag()) {
         Logger::info("Notify window resizing", "revector");
-        notify_primary_window_size_changed(get_primary_window().lock()->get_logical_size());
+        notify_primary_window_size_changed(primary_window->get_logical_size());
     }
 
+    update_node_table();
+
     // OpenGL calls in input callbacks cannot be made from another thread.
-    input_system(root.get(), InputServer::get_singleton()->input_queue);
+    auto input_server = InputServer::get_singleton();
+    input_server->coalesce_events();
+    input_system(input_server->input_queue);
+    input_server->mark_latency_stage(LatencyStage::Dispatched);
 
-    // Get ready from-back-to-front.
-    std::vector<Node*> nodes;
-    dfs_preorder_ltr_traversal(root.get(), nodes);
-    for (auto& node : nodes) {
-        node->ready();
+    // Get newly added nodes ready. Nodes added during this are handled in the same loop.
+    {
+        VECGUI_PROFILE_ZONE("Ready");
+
+        for (size_t i = 0; i < pending_ready_nodes.size(); i++) {
+            if (auto node = pending_ready_nodes[i]) {
+                node->ready();
+            }
+        }
+        pending_ready_nodes.clear();
     }
 
-    // Update from-back-to-front.
-    for (auto& node : nodes) {
-        if (!node->ready_) {
-            continue;
+    // Fire due timers.
+    {
+        VECGUI_PROFILE_ZONE("Timers");
+
+        TimerServer::get_singleton()->tick(dt);
+    }
+
+    // Only update nodes that opted in. Nodes registered during this loop are updated next frame.
+    {
+        VECGUI_PROFILE_ZONE("Update");
+
+        const auto processing_count = processing_nodes.size();
+        for (size_t i = 0; i < processing_count; i++) {
+            auto node = processing_nodes[i];
+            if (node && node->ready_) {
+                node->update(dt);
+            }
         }
-        node->update(dt);
+        std::erase(processing_nodes, nullptr);
     }
 
+    // Nodes may have been added or removed by the callbacks above.
+    update_node_table();
+
     // Run calc_minimum_size() depth-first.
-    calc_minimum_size(root.get());
+    calc_minimum_size(node_table, layout_grain_size);
 
     // Adjust container layouts.
-    layout_system(root.get());
+    layout_system(node_table, layout_grain_size);
 
     // Update global transform for each node.
-    transform_system(root.get());
+    transform_system(node_table, layout_grain_size);
+
+    InputServer::get_singleton()->mark_latency_stage(LatencyStage::Updated);
+}
+
+bool SceneTree::is_idle() const {
+    return pending_ready_nodes.empty() && processing_nodes.empty();
 }
 
-bool SceneTree::render() const {
+bool SceneTree::render() {
+    update_node_table();
+
+    // Headless without a device, there's nothing to draw with.
+    if (VectorServer::get_singleton()->get_canvas() == nullptr) {
+        return quited;
+    }
+
+    culled_node_count = 0;
+    drawn_window_count = 0;
+
+    std::vector<WindowFrame> window_frames;
+
     // Collect all windows.
-    std::vector<ProxyWindow*> sub_windows;
-    {
-        std::vector<Node*> nodes;
-        dfs_preorder_ltr_traversal(root.get(), nodes);
-        for (auto& node : nodes) {
-            if (typeid(*node) == typeid(ProxyWindow)) {
-                auto sub_window = dynamic_cast<ProxyWindow*>(node);
-                sub_windows.push_back(sub_window);
-            }
+    std::vector<uint32_t> window_rows;
+    for (uint32_t row = 0; row < node_table.size(); row++) {
+        if (node_table.nodes[row]->is_kind(NodeKind::Window)) {
+            window_rows.push_back(row);
         }
     }
 
     // Draw sub-windows.
-    for (const auto& w : sub_windows) {
+    for (auto window_row : window_rows) {
+        auto w = static_cast<ProxyWindow*>(node_table.nodes[window_row]);
+
+        w->sync_visibility();
+
         if (!w->get_visibility()) {
             continue;
         }
 
+        // Keep the flag queued until the window is actually drawn, e.g. while it has a zero size.
+        if (!redraw_all_windows && !w->is_redraw_needed() &&
+            !window_redraw_queued[w->window_index_].load(std::memory_order_relaxed)) {
+            continue;
+        }
+
         // Get all pop menus that belong to this window.
-        std::vector<PopupMenu*> popup_menus;
+        std::vector<uint32_t> popup_menu_rows;
+        for (uint32_t row = window_row; row < node_table.subtree_ends[window_row]; row++) {
+            if (node_table.nodes[row]->is_kind(NodeKind::Popup)) {
+                popup_menu_rows.push_back(row);
+            }
+        }
+
+        if (!w->pre_draw_propagation()) {
+            continue;
+        }
+
+        // Changes made while drawing are picked up next frame.
+        window_redraw_queued[w->window_index_].store(false, std::memory_order_relaxed);
+        drawn_window_count++;
+
         {
-            std::vector<Node*> nodes;
-            dfs_preorder_ltr_traversal(w, nodes);
-            for (auto& node : nodes) {
-                if (typeid(*node) == typeid(PopupMenu)) {
-                    auto popup_menu = dynamic_cast<PopupMenu*>(node);
-                    popup_menus.push_back(popup_menu);
+            VECGUI_PROFILE_ZONE("Draw window");
+
+            auto window_rect =
+                RectF({}, RenderServer::get_singleton()->get_window_logical_size(w->window_index_).to_f32());
+
+            // Collect renderable objects
+            draw_subtree(window_row, window_rect);
+
+            // Draw popup menus
+            for (auto row : popup_menu_rows) {
+                if (!node_table.nodes[row]->get_visibility()) {
+                    continue;
                 }
+
+                draw_subtree(row, window_rect);
             }
         }
 
-        w->pre_draw_propagation();
+        // Submit render commands
+        if (pipelined_rendering) {
+            window_frames.push_back(
+                {w, VectorServer::get_singleton()->take_scene(), w->get_vector_target(), w->drawn_size_});
+        } else {
+            w->post_draw_propagation();
+        }
+    }
 
-        // Collect renderable objects
-        propagate_draw(w);
+    if (!window_frames.empty()) {
+        submit_render_job(std::move(window_frames));
+    }
 
-        // Draw popup menus
-        for (const auto& m : popup_menus) {
-            if (!m->get_visibility()) {
-                continue;
-            }
+    auto primary_window = root->get_raw_window();
+
+    return (primary_window && primary_window->should_close()) || quited;
+}
+
+void SceneTree::set_pipelined_rendering(bool enabled) {
+    if (enabled == pipelined_rendering) {
+        return;
+    }
 
-            propagate_draw(m);
+    if (enabled) {
+        auto device = RenderServer::get_singleton()->device_;
+        if (device && device->get_backend_type() == Pathfinder::BackendType::Opengl) {
+            Logger::error("Pipelined rendering is not supported with OpenGL!", "revector");
+            return;
         }
 
-        // Submit render commands
-        w->post_draw_propagation();
+        pipelined_rendering = true;
+        Logger::info("Pipelined rendering enabled.", "revector");
+        return;
+    }
+
+    pipelined_rendering = false;
+
+    if (render_thread.joinable()) {
+        finish_rendering();
+
+        {
+            std::lock_guard lock(render_mutex);
+            render_thread_stopping = true;
+        }
+        render_condition.notify_all();
+
+        render_thread.join();
+        render_thread_stopping = false;
+    }
+}
+
+bool SceneTree::is_pipelined_rendering() const {
+    return pipelined_rendering;
+}
+
+void SceneTree::set_layout_grain_size(uint32_t grain_size) {
+    layout_grain_size = grain_size;
+}
+
+void SceneTree::finish_rendering() {
+    if (!render_thread.joinable()) {
+        return;
     }
 
-    return root->get_raw_window()->should_close() || quited;
+    {
+        VECGUI_PROFILE_ZONE("Wait for render thread");
+
+        std::unique_lock lock(render_mutex);
+        render_condition.wait(lock, [this] { return !render_job_queued; });
+    }
+
+    if (!render_job.windows.empty()) {
+        InputServer::get_singleton()->finish_latency_frame(render_job.latency);
+        render_job.windows.clear();
+    }
+}
+
+void SceneTree::submit_render_job(std::vector<WindowFrame>&& windows) {
+    finish_rendering();
+
+    if (!render_thread.joinable()) {
+        render_thread = std::thread(&SceneTree::render_thread_loop, this);
+    }
+
+    auto input_server = InputServer::get_singleton();
+    input_server->mark_latency_stage(LatencyStage::Drawn);
+
+    {
+        std::lock_guard lock(render_mutex);
+        render_job.windows = std::move(windows);
+        render_job.latency = input_server->take_latency_frame();
+        render_job_queued = true;
+    }
+    render_condition.notify_all();
+}
+
+void SceneTree::render_thread_loop() {
+    auto render_server = RenderServer::get_singleton();
+
+    while (true) {
+        {
+            std::unique_lock lock(render_mutex);
+            render_condition.wait(lock, [this] { return render_job_queued || render_thread_stopping; });
+
+            if (!render_job_queued) {
+                return;
+            }
+        }
+
+        {
+            std::lock_guard gpu_lock(render_server->gpu_mutex_);
+
+            for (auto& frame : render_job.windows) {
+                frame.window->present_frame(frame.scene, frame.vector_target, frame.size, render_job.latency);
+            }
+        }
+
+        {
+            std::lock_guard lock(render_mutex);
+            render_job_queued = false;
+        }
+        render_condition.notify_all();
+    }
 }
 
 void SceneTree::notify_primary_window_size_changed(Vec2I new_size) const {
@@ -1,21 +1,29 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 #include "file_dialog.h"
+#include "hit_test_grid.h"
 #include "node.h"
+#include "node_table.h"
 #include "timer.h"
 #include "ui/button/button.h"
 #include "ui/button/check_button.h"
 #include "ui/button/menu_button.h"
 #include "ui/button/radio_button.h"
 #include "ui/container/box_container.h"
+#include "ui/container/cached_layer.h"
 #include "ui/container/collapse_container.h"
 #include "ui/container/grid_container.h"
 #include "ui/container/margin_container.h"
 #include "ui/container/scroll_container.h"
 #include "ui/container/split_container.h"
 #include "ui/container/tab_container.h"
+#include "ui/frame_stats_overlay.h"
 #include "ui/label.h"
 #include "ui/panel.h"
 #include "ui/popup_menu.h"
@@ -34,25 +42,73 @@ namespace vecgui {
 
 class ProxyWindow;
 
-void transform_system(Node* root);
-
 void propagate_draw(Node* node);
 
-/// Run calc_minimum_size() depth-first.
-void calc_minimum_size(Node* root);
+/// Subtrees with no more nodes than this are processed serially by the layout and transform passes.
+/// Pass UINT32_MAX to force a fully serial pass.
+constexpr uint32_t LAYOUT_PARALLEL_GRAIN_SIZE = 512;
+
+/// Run calc_minimum_size() leaf-to-root. Independent subtrees larger than the grain size are processed in parallel.
+void calc_minimum_size(const NodeTable& table, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
+
+/// Run adjust_layout() root-to-leaf. Once a container is arranged, its child subtrees are processed in parallel
+/// if they are larger than the grain size. The result is identical to that of a serial pass.
+void layout_system(NodeTable& table, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
+
+/// Recalculate global transforms, only for subtrees that have been moved, rotated or scaled since the last run.
+void transform_system(NodeTable& table, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
 
-void layout_system(Node* root);
+// For detached subtrees. These build a temporary node table.
+void calc_minimum_size(Node* root, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
+void layout_system(Node* root, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
+void transform_system(Node* root, uint32_t grain_size = LAYOUT_PARALLEL_GRAIN_SIZE);
 
 /// Processing order: Input -> Update -> Draw.
 class SceneTree {
     friend class App;
+    friend class Node;
 
 public:
     explicit SceneTree(Vec2I primary_window_size);
 
+    ~SceneTree();
+
     void process(double dt);
 
-    bool render() const;
+    bool render();
+
+    /// If nothing will change until the next input or timer deadline,
+    /// i.e. no node is waiting to get ready and no node processes every frame.
+    bool is_idle() const;
+
+    /// Up to date after process().
+    const NodeTable& get_node_table() const;
+
+    /// Nodes the last render() skipped, along with their subtrees, for being outside their window or an enclosing
+    /// scroll container.
+    uint32_t get_culled_node_count() const;
+
+    /// Windows the last render() drew. Windows without a queued redraw (see Node::queue_redraw()) are skipped,
+    /// their last frame stays on screen.
+    uint32_t get_drawn_window_count() const;
+
+    /// Redraw every visible window every frame, e.g. if a custom node changes its looks without queueing a redraw.
+    /// Off by default.
+    void set_redraw_all_windows(bool enabled);
+
+    /// Hand the recorded scenes of each frame to a render thread, which tiles, submits and presents them while
+    /// the next frame runs input, update, layout and draw recording. At most one frame is in flight, so this adds
+    /// at most a frame of latency. Off by default, i.e. everything runs on the calling thread.
+    /// Not supported with OpenGL, whose context is bound to the main thread.
+    void set_pipelined_rendering(bool enabled);
+
+    bool is_pipelined_rendering() const;
+
+    /// Wait until the render thread has presented the frame in flight, e.g. before destroying swap chains.
+    void finish_rendering();
+
+    /// See LAYOUT_PARALLEL_GRAIN_SIZE, which is the default.
+    void set_layout_grain_size(uint32_t grain_size);
 
     std::shared_ptr<Node> get_root() const;
 
@@ -63,13 +119,133 @@ public:
     std::weak_ptr<Pathfinder::Window> get_primary_window() const;
 
 private:
+    /// Called when a node enters the tree.
+    void register_node(Node* node);
+
+    void register_process(Node* node);
+
+    void unregister_process(Node* node);
+
+    /// Forget a node leaving the tree.
+    void unregister_node(Node* node);
+
+    /// Rebuild the node table if nodes have been added or removed.
+    void update_node_table();
+
+    /// Rebuild the hit-test grid along with the node table, or re-index moved and resized nodes.
+    void update_hit_test_grid();
+
+    /// Front-to-back. For each window and popup, mouse events only go to nodes found by the hit-test grid
+    /// and their ancestors, other events go to all nodes.
+    void input_system(std::vector<InputEvent>& input_queue);
+
+    /// Deliver a mouse event to the nodes under the cursor, and to tracked, captured and global nodes,
+    /// within the subtree of a window or popup.
+    void dispatch_mouse_event(uint32_t root_row, InputEvent& event);
+
+    /// Recorded draws of a window, for the render thread.
+    struct WindowFrame {
+        ProxyWindow* window;
+        std::shared_ptr<Pathfinder::Scene> scene;
+        std::shared_ptr<Pathfinder::Texture> vector_target;
+        /// Physical size, taken on the main thread when the frame was recorded.
+        Vec2I size;
+    };
+
+    /// Wait for the frame in flight, then hand over the next one.
+    void submit_render_job(std::vector<WindowFrame>&& windows);
+
+    void render_thread_loop();
+
+    /// Like propagate_draw(), but skips UI nodes whose global bounds miss the clip rect, unless something in their
+    /// subtree overflows. Clip rects of ScrollContainers are intersected on the way down.
+    void draw_subtree(uint32_t row, RectF clip);
+
     /// Primary window
     std::shared_ptr<ProxyWindow> root;
 
+    /// Thread-safe, so parallel layout can queue redraws too.
+    void queue_window_redraw(uint8_t window_index);
+
+    /// Nodes that have entered the tree but are not ready yet, parents before children.
+    std::vector<Node*> pending_ready_nodes;
+
+    /// Nodes that opted in to per-frame update. Unregistered entries are nulled out during a frame.
+    std::vector<Node*> processing_nodes;
+
+    uint32_t node_id_count = 0;
+
+    std::vector<uint32_t> free_node_ids;
+
+    NodeTable node_table;
+
+    bool node_table_dirty = true;
+
+    HitTestGrid hit_test_grid;
+
+    bool hit_test_grid_dirty = true;
+
+    /// Hovered or focused nodes. They receive mouse events anywhere until the cursor leaves or they lose focus.
+    std::vector<Node*> mouse_tracked_nodes;
+
+    /// Nodes that received a mouse button press. They receive mouse events anywhere until the release.
+    std::vector<Node*> mouse_captured_nodes;
+
+    struct MouseTarget {
+        uint32_t row;
+        /// Nulled if the node leaves the tree during dispatching.
+        Node* node;
+        /// Under a ScrollContainer the cursor is outside of.
+        bool clipped;
+    };
+
+    /// Per-row routing state of the current mouse event, valid if the stamp matches.
+    struct MouseRoute {
+        uint32_t stamp = 0;
+        uint8_t state = 0;
+        uint8_t child_state = 0;
+        bool special = false;
+    };
+
+    // Scratch buffers of dispatch_mouse_event().
+    std::vector<MouseTarget> mouse_targets;
+    std::vector<uint32_t> mouse_candidate_rows;
+    std::vector<uint32_t> mouse_route_chain;
+    std::vector<MouseRoute> mouse_routes;
+    uint32_t mouse_route_stamp = 0;
+
+    uint32_t culled_node_count = 0;
+
+    /// By window index.
+    std::array<std::atomic<bool>, MAX_WINDOW_COUNT> window_redraw_queued;
+
+    uint32_t drawn_window_count = 0;
+
+    bool redraw_all_windows = false;
+
     bool quited = false;
 
-    // todo
+    bool pipelined_rendering = false;
+
+    uint32_t layout_grain_size = LAYOUT_PARALLEL_GRAIN_SIZE;
+
+    /// Started with the first frame handed over, see set_pipelined_rendering().
     std::thread render_thread;
+
+    std::mutex render_mutex;
+
+    /// Signals a queued or finished job and stopping.
+    std::condition_variable render_condition;
+
+    /// Owned by the render thread while queued.
+    struct {
+        std::vector<WindowFrame> windows;
+        LatencyFrame latency;
+    } render_job;
+
+    bool render_job_queued = false;
+
+    bool render_thread_stopping = false;
 };
 
 } // namespace vecgui
@@ -6,53 +6,75 @@
 
 namespace vecgui {
 
+Timer::~Timer() {
+    stop();
+}
+
 void Timer::start_timer(float time) {
     if (time <= 0) {
         return;
     }
-    remaining_time_ = time;
-    is_stopped_ = false;
-}
 
-void Timer::update(double dt) {
-    Node::update(dt);
+    // Restart if already running.
+    stop();
 
-    if (!is_stopped_ && remaining_time_ > 0) {
-        remaining_time_ -= dt;
+    if (!get_tree()) {
+        pending_time_ = time;
+        return;
     }
 
-    if (!is_stopped_ && remaining_time_ <= 0) {
-        is_stopped_ = true;
-        remaining_time_ = 0;
+    start_server_timer(time);
+}
+
+void Timer::start_server_timer(float time) {
+    timer_id_ = TimerServer::get_singleton()->start(time, [this] {
+        timer_id_ = {};
         emit_timeout();
-    }
+    });
 }
 
 void Timer::connect_signal(const std::string& signal, const AnyCallable<void>& callback) {
     Node::connect_signal(signal, callback);
 
     if (signal == "timeout") {
-        timeout_callbacks.emplace_back(callback);
+        connect_any_callable(signal_timeout, callback);
     }
 }
 
 float Timer::get_remaining_time() const {
-    return remaining_time_;
+    if (pending_time_ > 0) {
+        return pending_time_;
+    }
+
+    return TimerServer::get_singleton()->get_remaining_time(timer_id_);
 }
 
 bool Timer::is_stopped() const {
-    return is_stopped_;
+    return pending_time_ <= 0 && !TimerServer::get_singleton()->is_active(timer_id_);
 }
 
 void Timer::stop() {
-    remaining_time_ = 0;
-    is_stopped_ = true;
+    pending_time_ = 0;
+
+    if (timer_id_) {
+        TimerServer::get_singleton()->stop(timer_id_);
+        timer_id_ = {};
+    }
 }
 
-void Timer::emit_timeout() {
-    for (auto& c : timeout_callbacks) {
-        c();
+void Timer::enter_tree() {
+    if (pending_time_ > 0) {
+        start_server_timer(pending_time_);
+        pending_time_ = 0;
     }
 }
 
+void Timer::exit_tree() {
+    stop();
+}
+
+void Timer::emit_timeout() {
+    signal_timeout.emit();
+}
+
 } // namespace vecgui
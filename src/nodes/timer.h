@@ -6,15 +6,19 @@
 #include "../common/any_callable.h"
 #include "../common/utils.h"
 #include "../servers/engine.h"
+#include "../servers/timer_server.h"
 #include "node.h"
 
 namespace vecgui {
 
+/// A one-shot timer backed by the TimerServer. It doesn't need per-frame processing.
+/// Like other nodes, it only runs inside a scene tree: started outside, it waits for the node to enter one, and it
+/// stops when the node leaves the tree.
 class Timer final : public Node {
 public:
-    void start_timer(float time);
+    ~Timer() override;
 
-    void update(double dt) override;
+    void start_timer(float time);
 
     void connect_signal(const std::string& signal, const AnyCallable<void>& callback) override;
 
@@ -24,12 +28,21 @@ public:
 
     void stop();
 
+    void enter_tree() override;
+
+    void exit_tree() override;
+
+    Signal<> signal_timeout;
+
 protected:
     void emit_timeout();
 
-    bool is_stopped_ = true;
-    double remaining_time_ = 0;
-    std::vector<AnyCallable<void>> timeout_callbacks;
+    void start_server_timer(float time);
+
+    TimerId timer_id_{};
+
+    /// Seconds to run once inside the tree, see start_timer().
+    float pending_time_ = 0;
 };
 
 } // namespace vecgui
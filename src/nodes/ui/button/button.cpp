@@ -14,24 +14,24 @@ Button::Button() {
     auto default_theme = DefaultResource::get_singleton()->get_default_theme();
 
     // Don't add the label as a child since it's not a normal node but part of the button.
-    label = std::make_shared<Label>();
+    label = make_node<Label>();
     label->set_text("Button");
     label->set_horizontal_alignment(Alignment::Center);
     label->set_vertical_alignment(Alignment::Center);
     label->container_sizing.flag_h = ContainerSizingFlag::Fill;
     label->set_mouse_filter(MouseFilter::Ignore);
 
-    icon_rect = std::make_shared<TextureRect>();
+    icon_rect = make_node<TextureRect>();
     icon_rect->set_stretch_mode(TextureRect::StretchMode::KeepCentered);
     icon_rect->set_mouse_filter(MouseFilter::Ignore);
 
-    hbox_container = std::make_shared<HBoxContainer>();
+    hbox_container = make_node<HBoxContainer>();
     hbox_container->add_child(icon_rect);
     hbox_container->add_child(label);
     hbox_container->set_separation(2);
     hbox_container->set_mouse_filter(MouseFilter::Ignore);
 
-    margin_container = std::make_shared<MarginContainer>();
+    margin_container = make_node<MarginContainer>();
     margin_container->set_margin_all(4);
     margin_container->add_child(hbox_container);
     margin_container->set_anchor_flag(AnchorFlag::FullRect);
@@ -39,12 +39,12 @@ Button::Button() {
 
     add_embedded_child(margin_container);
 
-    callbacks_cursor_entered.emplace_back([this] {
+    signal_cursor_entered.connect([this] {
         hovered = true;
         // InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::Hand);
     });
 
-    callbacks_cursor_exited.emplace_back([this] {
+    signal_cursor_exited.connect([this] {
         hovered = false;
         // InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::Arrow);
     });
@@ -67,6 +67,9 @@ void Button::ready() {
 }
 
 void Button::input(InputEvent &event) {
+    bool was_pressed = pressed;
+    bool was_toggled = toggled;
+
     auto global_position = get_global_position();
 
     bool consume_flag = false;
@@ -135,6 +138,10 @@ void Button::input(InputEvent &event) {
         }
     }
 
+    if (pressed != was_pressed || toggled != was_toggled) {
+        queue_redraw();
+    }
+
     NodeUi::input(event);
 }
 
@@ -200,25 +207,19 @@ void Button::draw() {
 }
 
 void Button::set_position(Vec2F new_position) {
-    position = new_position;
+    NodeUi::set_position(new_position);
 }
 
 void Button::notify_pressed() {
-    for (auto &callback : pressed_callbacks) {
-        callback();
-    }
+    signal_pressed.emit();
 }
 
 void Button::notify_released() {
-    for (auto &callback : released_callbacks) {
-        callback();
-    }
+    signal_released.emit();
 }
 
 void Button::notify_triggered() {
-    for (auto &callback : triggered_callbacks) {
-        callback();
-    }
+    signal_triggered.emit();
 }
 
 void Button::notify_toggled(bool toggled) {
@@ -226,32 +227,26 @@ void Button::notify_toggled(bool toggled) {
         return;
     }
 
-    for (auto &callback : toggled_callbacks) {
-        try {
-            callback.operator()<bool>(std::move(toggled));
-        } catch (std::bad_any_cast &) {
-            Logger::error("Mismatched signal argument types!", "revector");
-        }
-    }
+    signal_toggled.emit(toggled);
 }
 
 void Button::connect_signal(const std::string &signal, const AnyCallable<void> &callback) {
     NodeUi::connect_signal(signal, callback);
 
     if (signal == "hovered") {
-        hovered_callbacks.push_back(callback);
+        connect_any_callable(signal_hovered, callback);
     }
     if (signal == "pressed") {
-        pressed_callbacks.push_back(callback);
+        connect_any_callable(signal_pressed, callback);
     }
     if (signal == "released") {
-        released_callbacks.push_back(callback);
+        connect_any_callable(signal_released, callback);
     }
     if (signal == "triggered") {
-        triggered_callbacks.push_back(callback);
+        connect_any_callable(signal_triggered, callback);
     }
     if (signal == "toggled") {
-        toggled_callbacks.push_back(callback);
+        connect_any_callable(signal_toggled, callback);
     }
 }
 
@@ -272,10 +267,12 @@ std::string Button::get_text() const {
 
 void Button::set_icon_normal(const std::shared_ptr<Image> &icon) {
     icon_normal_ = icon;
+    queue_redraw();
 }
 
 void Button::set_icon_pressed(const std::shared_ptr<Image> &icon) {
     icon_pressed_ = icon;
+    queue_redraw();
 }
 
 void Button::set_icon_expand(bool enable) {
@@ -284,6 +281,8 @@ void Button::set_icon_expand(bool enable) {
     } else {
         icon_rect->container_sizing.flag_h = ContainerSizingFlag::NoExpand;
     }
+
+    queue_relayout();
 }
 
 void Button::set_toggle_mode(bool enable) {
@@ -301,6 +300,8 @@ void Button::set_toggled(bool p_toggled) {
 
     notify_toggled(p_toggled);
     toggled = p_toggled;
+
+    queue_redraw();
 }
 
 void Button::trigger() {
@@ -75,6 +75,13 @@ public:
 
     ToggleButtonGroup *group = nullptr;
 
+    // Signals.
+    Signal<> signal_hovered;       // Cursor entered
+    Signal<> signal_pressed;       // Button is down
+    Signal<> signal_released;      // Button is up
+    Signal<> signal_triggered;     // Button pressed then released
+    Signal<bool> signal_toggled;   // For toggle mode only
+
     // Style overrides.
     std::optional<StyleBox> theme_override_normal;
     std::optional<StyleBox> theme_override_hovered;
@@ -105,13 +112,6 @@ protected:
     std::shared_ptr<Image> icon_normal_;
     std::shared_ptr<Image> icon_pressed_;
 
-    // Callbacks.
-    std::vector<AnyCallable<void>> hovered_callbacks;   // Cursor entered
-    std::vector<AnyCallable<void>> pressed_callbacks;   // Button is down
-    std::vector<AnyCallable<void>> released_callbacks;  // Button is up
-    std::vector<AnyCallable<void>> triggered_callbacks; // Button pressed then released
-    std::vector<AnyCallable<void>> toggled_callbacks;   // For toggle mode only
-
     void notify_pressed();
 
     void notify_released();
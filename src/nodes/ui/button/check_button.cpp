@@ -11,8 +11,8 @@ CheckButton::CheckButton() {
 
     label->set_text("Check Button");
 
-    icon_normal_ = std::make_shared<VectorImage>(get_asset_dir("icons/CheckBox_Unchecked.svg"), true);
-    icon_pressed_ = std::make_shared<VectorImage>(get_asset_dir("icons/CheckBox_Checked.svg"), true);
+    icon_normal_ = DefaultResource::get_singleton()->get_icon("icons/CheckBox_Unchecked.svg", true);
+    icon_pressed_ = DefaultResource::get_singleton()->get_icon("icons/CheckBox_Checked.svg", true);
 }
 
 } // namespace vecgui
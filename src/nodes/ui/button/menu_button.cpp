@@ -11,15 +11,15 @@ MenuButton::MenuButton() {
 
     label->set_text("Menu Button");
 
-    menu = std::make_shared<PopupMenu>();
+    menu = make_node<PopupMenu>();
     // Add a Node to disable transform propagation since a PopupMenu will always be in the global coordinates.
-    auto node = std::make_shared<Node>();
+    auto node = make_node<Node>();
     add_embedded_child(node);
     node->add_child(menu);
 
     menu->set_visibility(false);
 
-    triggered_callbacks.emplace_back([this] {
+    signal_triggered.connect([this] {
         if (menu->get_item_count() == 0) {
             return;
         }
@@ -11,8 +11,8 @@ RadioButton::RadioButton() {
 
     label->set_text("Radio Button");
 
-    icon_normal_ = std::make_shared<VectorImage>(get_asset_dir("icons/GuiRadioUnchecked.svg"), true);
-    icon_pressed_ = std::make_shared<VectorImage>(get_asset_dir("icons/GuiRadioChecked.svg"), true);
+    icon_normal_ = DefaultResource::get_singleton()->get_icon("icons/GuiRadioUnchecked.svg", true);
+    icon_pressed_ = DefaultResource::get_singleton()->get_icon("icons/GuiRadioChecked.svg", true);
 }
 
 } // namespace vecgui
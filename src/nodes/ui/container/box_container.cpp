@@ -239,10 +239,13 @@ void BoxContainer::set_separation(float new_separation) {
     }
 
     separation = new_separation;
+
+    queue_relayout();
 }
 
 void BoxContainer::set_alignment(BoxContainerAlignment new_alignment) {
     alignment = new_alignment;
+    queue_relayout();
 }
 
 } // namespace vecgui
@@ -0,0 +1,176 @@
+#include "cached_layer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../../../servers/engine.h"
+#include "../../../servers/render_server.h"
+#include "../../../servers/vector_server.h"
+
+namespace vecgui {
+
+/// RGBA8.
+constexpr size_t CACHED_LAYER_BYTES_PER_PIXEL = 4;
+
+size_t cached_layer_memory_budget = 256 * 1024 * 1024;
+
+/// All layers, so caches can be evicted across them.
+std::vector<CachedLayer *> &get_cached_layers() {
+    static std::vector<CachedLayer *> layers;
+    return layers;
+}
+
+CachedLayer::CachedLayer() {
+    type = NodeType::CachedLayer;
+    set_kind(NodeKind::CachedLayer, true);
+
+    get_cached_layers().push_back(this);
+}
+
+CachedLayer::~CachedLayer() {
+    std::erase(get_cached_layers(), this);
+}
+
+void CachedLayer::pre_draw_children() {
+    draw_state_ = DrawState::Direct;
+
+    if (!visible_) {
+        return;
+    }
+
+    auto vector_server = VectorServer::get_singleton();
+
+    auto scale = vector_server->get_global_scale();
+    auto physical_size = Vec2I(std::ceil(size.x * scale), std::ceil(size.y * scale));
+
+    size_t bytes = (size_t)physical_size.x * physical_size.y * CACHED_LAYER_BYTES_PER_PIXEL;
+
+    if (physical_size.is_any_zero() || bytes > cached_layer_memory_budget ||
+        RenderServer::get_singleton()->device_ == nullptr) {
+        evict();
+        return;
+    }
+
+    last_drawn_time_ = Engine::get_singleton()->get_elapsed();
+
+    if (cache_ && !cache_dirty_ && cache_scale_ == scale && cache_->get_size() == physical_size) {
+        draw_state_ = DrawState::Cached;
+        return;
+    }
+
+    if (!cache_ || cache_->get_size() != physical_size) {
+        evict();
+        make_room(bytes);
+        cache_ = std::make_shared<RenderImage>(physical_size);
+    }
+
+    // Changes while recording are picked up next frame.
+    cache_dirty_ = false;
+    cache_scale_ = scale;
+
+    vector_server->begin_layer(cache_->get_texture(), get_global_position());
+    draw_state_ = DrawState::Recording;
+}
+
+void CachedLayer::post_draw_children() {
+    if (draw_state_ == DrawState::Direct) {
+        return;
+    }
+
+    auto vector_server = VectorServer::get_singleton();
+
+    if (draw_state_ == DrawState::Recording) {
+        vector_server->end_layer();
+    }
+
+    // The cache has the physical size, so undo the DPI scaling.
+    vector_server->draw_render_image(*cache_,
+                                     Transform2::from_translation(get_global_position()) *
+                                         Transform2::from_scale(Vec2F(1.0f / cache_scale_)));
+}
+
+bool CachedLayer::invalidate() {
+    return !cache_dirty_.exchange(true);
+}
+
+bool CachedLayer::should_draw_children() const {
+    return draw_state_ != DrawState::Cached;
+}
+
+bool CachedLayer::is_recording() const {
+    return draw_state_ == DrawState::Recording;
+}
+
+size_t CachedLayer::get_memory_usage() const {
+    if (!cache_) {
+        return 0;
+    }
+
+    auto cache_size = cache_->get_size();
+    return (size_t)cache_size.x * cache_size.y * CACHED_LAYER_BYTES_PER_PIXEL;
+}
+
+void CachedLayer::evict() {
+    cache_.reset();
+    cache_dirty_ = true;
+}
+
+void CachedLayer::set_memory_budget(size_t bytes) {
+    cached_layer_memory_budget = bytes;
+
+    // Shrink right away, keeping the most recently drawn caches.
+    auto usage = get_total_memory_usage();
+    if (usage > bytes) {
+        auto &layers = get_cached_layers();
+        std::ranges::sort(layers, {}, [](CachedLayer *layer) { return layer->last_drawn_time_; });
+
+        for (auto layer : layers) {
+            if (usage <= bytes) {
+                break;
+            }
+            usage -= layer->get_memory_usage();
+            layer->evict();
+        }
+    }
+}
+
+size_t CachedLayer::get_memory_budget() {
+    return cached_layer_memory_budget;
+}
+
+size_t CachedLayer::get_total_memory_usage() {
+    size_t usage = 0;
+    for (auto layer : get_cached_layers()) {
+        usage += layer->get_memory_usage();
+    }
+    return usage;
+}
+
+void CachedLayer::make_room(size_t bytes) {
+    auto usage = get_total_memory_usage();
+    if (usage + bytes <= cached_layer_memory_budget) {
+        return;
+    }
+
+    auto now = Engine::get_singleton()->get_elapsed();
+
+    auto layers = get_cached_layers();
+    std::ranges::sort(layers, {}, [](CachedLayer *layer) { return layer->last_drawn_time_; });
+
+    for (auto layer : layers) {
+        if (usage + bytes <= cached_layer_memory_budget) {
+            break;
+        }
+        // Caches drawn this frame are in use, so the budget may be exceeded for a while.
+        if (layer == this || layer->last_drawn_time_ == now || layer->get_memory_usage() == 0) {
+            continue;
+        }
+
+        usage -= layer->get_memory_usage();
+        layer->evict();
+
+        Logger::verbose("Evicted a cached layer to stay within the memory budget.", "revector");
+    }
+}
+
+} // namespace vecgui
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+
+#include "../../../resources/render_image.h"
+#include "container.h"
+
+namespace vecgui {
+
+/// Draws its subtree into a texture once, then only draws the texture, until something inside changes visually
+/// (see Node::queue_redraw()) or the layer is resized or rescaled. Meant for complex but mostly static content,
+/// like charts, SVG-heavy toolbars or icon grids, which then cost a single textured quad per frame.
+/// Children fill the layer, like in a plain Container. A rotated or scaled layer draws its cache transformed, which is
+/// recorded at the DPI scale only, so it gets blurry when scaled up.
+///
+/// Caches of all layers share a memory budget. When it's exceeded, the least recently drawn caches are evicted,
+/// and layers too large for the budget are drawn directly.
+class CachedLayer : public Container {
+public:
+    CachedLayer();
+
+    ~CachedLayer() override;
+
+    void pre_draw_children() override;
+
+    void post_draw_children() override;
+
+    /// Re-render on the next frame. Returns false if the cache was already invalid. Thread-safe.
+    bool invalidate();
+
+    /// If the children have to be drawn this frame, either into the cache or directly.
+    /// Only meaningful between pre_draw_children() and post_draw_children().
+    bool should_draw_children() const;
+
+    /// If the children are being drawn into the cache, and so not clipped by anything outside the layer.
+    bool is_recording() const;
+
+    /// In bytes.
+    size_t get_memory_usage() const;
+
+    /// Drop the cache, e.g. to free memory. It's re-rendered when the layer is drawn again.
+    void evict();
+
+    /// In bytes, over all layers. 256 MiB by default.
+    static void set_memory_budget(size_t bytes);
+
+    static size_t get_memory_budget();
+
+    static size_t get_total_memory_usage();
+
+private:
+    enum class DrawState {
+        /// Caching is not possible, e.g. the layer is too large for the budget.
+        Direct,
+        /// Drawing from the cache.
+        Cached,
+        /// Drawing the children into the cache.
+        Recording,
+    };
+
+    /// Evict the least recently drawn caches of other layers until `bytes` more fit into the budget.
+    void make_room(size_t bytes);
+
+    std::shared_ptr<RenderImage> cache_;
+
+    float cache_scale_ = 0;
+
+    std::atomic<bool> cache_dirty_ = true;
+
+    DrawState draw_state_ = DrawState::Direct;
+
+    /// Engine time of the last draw, for eviction.
+    double last_drawn_time_ = 0;
+};
+
+} // namespace vecgui
@@ -15,14 +15,14 @@ CollapseContainer::CollapseContainer(CollapseButtonType button_type) {
 
     switch (button_type) {
         case CollapseButtonType::Check: {
-            collapse_button_ = std::make_shared<CheckButton>();
+            collapse_button_ = make_node<CheckButton>();
             collapse_button_->set_icon_normal(
-                std::make_shared<VectorImage>(get_asset_dir("icons/toggle_off.svg"), true));
+                DefaultResource::get_singleton()->get_icon("icons/toggle_off.svg", true));
             collapse_button_->set_icon_pressed(
-                std::make_shared<VectorImage>(get_asset_dir("icons/toggle_on.svg"), true));
+                DefaultResource::get_singleton()->get_icon("icons/toggle_on.svg", true));
         } break;
         default: {
-            collapse_button_ = std::make_shared<Button>();
+            collapse_button_ = make_node<Button>();
         } break;
     }
 
@@ -56,7 +56,7 @@ void CollapseContainer::adjust_layout() {
         if (child->is_ui_node()) {
             auto child_size = size;
             child_size -= Vec2F{margin_ * 2, margin_ * 2 + title_bar_height_};
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             cast_child->set_position({margin_, title_bar_height_ + margin_});
             cast_child->set_size(child_size);
         }
@@ -67,6 +67,7 @@ void CollapseContainer::adjust_layout() {
 
 void CollapseContainer::set_color(ColorU color) {
     theme_color_ = color;
+    queue_redraw();
 }
 
 void CollapseContainer::set_collapse(bool collapse) {
@@ -85,6 +86,9 @@ void CollapseContainer::set_collapse(bool collapse) {
     if (collapse) {
         this->size_before_collapse_ = this->size;
     }
+
+    // The minimum size and the children's visibility change.
+    queue_relayout();
 }
 
 bool CollapseContainer::get_collapse() const {
@@ -115,7 +119,7 @@ void CollapseContainer::calc_minimum_size() {
     if (!collapsed_) {
         for (const auto &child : children) {
             if (child->is_ui_node()) {
-                auto cast_child = dynamic_cast<NodeUi *>(child.get());
+                auto cast_child = static_cast<NodeUi *>(child.get());
                 auto child_min_size = cast_child->get_effective_minimum_size();
                 min_child_size = min_child_size.max(child_min_size);
             }
@@ -127,7 +131,7 @@ void CollapseContainer::calc_minimum_size() {
     Vec2F min_embeded_child_size{};
     for (const auto &child : embedded_children) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             auto child_min_size = cast_child->get_effective_minimum_size();
             min_embeded_child_size = min_embeded_child_size.max(child_min_size);
         }
@@ -141,12 +145,6 @@ void CollapseContainer::set_title(std::string title) {
     collapse_button_->set_text(title);
 }
 
-void CollapseContainer::update(double dt) {
-    NodeUi::update(dt);
-
-    adjust_layout();
-}
-
 void CollapseContainer::draw() {
     if (!visible_) {
         return;
@@ -18,8 +18,6 @@ class CollapseContainer : public Container {
 public:
     CollapseContainer(CollapseButtonType button_type);
 
-    void update(double dt) override;
-
     void draw() override;
 
     void calc_minimum_size() override;
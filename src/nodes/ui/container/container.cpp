@@ -4,6 +4,7 @@ namespace vecgui {
 
 Container::Container() {
     type = NodeType::NotInstantiable;
+    set_kind(NodeKind::Container, true);
 }
 
 void Container::adjust_layout() {
@@ -18,7 +19,7 @@ void Container::adjust_layout() {
         if (!child->is_ui_node()) {
             continue;
         }
-        auto cast_child = dynamic_cast<NodeUi *>(child.get());
+        auto cast_child = static_cast<NodeUi *>(child.get());
         cast_child->set_position({0, 0});
         cast_child->set_size(size);
     }
@@ -31,7 +32,7 @@ void Container::calc_minimum_size() {
         if (!child->is_ui_node()) {
             continue;
         }
-        auto cast_child = dynamic_cast<NodeUi *>(child.get());
+        auto cast_child = static_cast<NodeUi *>(child.get());
         auto child_min_size = cast_child->get_effective_minimum_size();
         min_child_size = min_child_size.max(child_min_size);
     }
@@ -70,7 +71,7 @@ std::vector<NodeUi *> Container::get_visible_ui_children() const {
             continue;
         }
 
-        auto cast_child = dynamic_cast<NodeUi *>(child.get());
+        auto cast_child = static_cast<NodeUi *>(child.get());
 
         ui_children.push_back(cast_child);
     }
@@ -85,14 +85,18 @@ void GridContainer::set_separation(float new_separation) {
     }
 
     separation = new_separation;
+
+    queue_relayout();
 }
 
 void GridContainer::set_column_limit(uint32_t new_limit) {
     col_limit = new_limit;
+    queue_relayout();
 }
 
 void GridContainer::set_item_shrinking(bool new_shrinking) {
     shrinking = new_shrinking;
+    queue_relayout();
 }
 
 } // namespace vecgui
@@ -8,7 +8,7 @@ void MarginContainer::calc_minimum_size() {
     Vec2F max_child_min_size;
     for (auto &child : children) {
         if (child->is_ui_node()) {
-            auto ui_child = dynamic_cast<NodeUi *>(child.get());
+            auto ui_child = static_cast<NodeUi *>(child.get());
             auto child_min_size = ui_child->get_effective_minimum_size();
 
             max_child_min_size = max_child_min_size.max(child_min_size + margin_size);
@@ -30,7 +30,7 @@ void MarginContainer::adjust_layout() {
 
     for (auto &child : children) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             cast_child->set_position(child_position);
 
             cast_child->set_size(child_size);
@@ -40,10 +40,12 @@ void MarginContainer::adjust_layout() {
 
 void MarginContainer::set_margin_all(float margin) {
     margin_ = {margin, margin, margin, margin};
+    queue_relayout();
 }
 
 void MarginContainer::set_margin(const RectF &margin) {
     margin_ = margin;
+    queue_relayout();
 }
 
 RectF MarginContainer::get_margin() const {
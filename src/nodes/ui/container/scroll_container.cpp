@@ -6,6 +6,8 @@ namespace vecgui {
 
 ScrollContainer::ScrollContainer() {
     type = NodeType::ScrollContainer;
+    set_kind(NodeKind::ClipsChildren, true);
+    update_layout_boundary();
 
     theme_scroll_bar.bg_color = ColorU(100, 100, 100, 0);
     theme_scroll_bar.corner_radius = 0;
@@ -35,7 +37,7 @@ void ScrollContainer::adjust_layout() {
     // Adjust child size.
     for (auto &child : children) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
 
             if (!vscroll_enabled) {
                 cast_child->set_size({cast_child->get_size().x, size.y});
@@ -45,6 +47,9 @@ void ScrollContainer::adjust_layout() {
             }
         }
     }
+
+    // Content or own size may have changed.
+    apply_scroll();
 }
 
 void ScrollContainer::calc_minimum_size() {
@@ -54,7 +59,7 @@ void ScrollContainer::calc_minimum_size() {
         if (!child->is_ui_node()) {
             continue;
         }
-        auto cast_child = dynamic_cast<NodeUi *>(child.get());
+        auto cast_child = static_cast<NodeUi *>(child.get());
         auto child_min_size = cast_child->get_effective_minimum_size();
         min_child_size = min_child_size.max(child_min_size);
     }
@@ -80,7 +85,7 @@ void ScrollContainer::input(InputEvent &event) {
         case InputEventType::MouseScroll: {
             float delta = event.args.mouse_scroll.y_delta;
 
-            if (active_rect.contains_point(InputServer::get_singleton()->cursor_position)) {
+            if (active_rect.contains_point(window_to_global(InputServer::get_singleton()->cursor_position))) {
                 if (!event.consumed) {
                     if (hscroll_enabled && !vscroll_enabled) {
                         hscroll -= delta * scroll_speed;
@@ -91,6 +96,7 @@ void ScrollContainer::input(InputEvent &event) {
                             vscroll -= delta * scroll_speed;
                         }
                     }
+                    apply_scroll();
                 }
 
                 // Will stop input propagation.
@@ -115,6 +121,9 @@ void ScrollContainer::input(InputEvent &event) {
                     if (max_movement.length() > 1) {
                         inertial_speed = max_movement * inertia;
                         lerp_elapsed_ = 0;
+
+                        // Only process while gliding.
+                        set_process(true);
                     }
 
                     pressed_mouse_position.reset();
@@ -131,6 +140,7 @@ void ScrollContainer::input(InputEvent &event) {
             if (pressed_mouse_position.has_value()) {
                 hscroll = prev_hscroll.value() - (args.position.x - pressed_mouse_position.value().x);
                 vscroll = prev_vscroll.value() - (args.position.y - pressed_mouse_position.value().y);
+                apply_scroll();
             }
         } break;
         default:
@@ -143,10 +153,6 @@ void ScrollContainer::input(InputEvent &event) {
 void ScrollContainer::update(double dt) {
     NodeUi::update(dt);
 
-    if (children.empty() || !children.front()->is_ui_node()) {
-        return;
-    }
-
     if (inertial_speed.length() > 0) {
         lerp_elapsed_ += dt;
         float t = std::clamp(lerp_elapsed_ / lerp_duration_, 0.0f, 1.0f);
@@ -157,6 +163,18 @@ void ScrollContainer::update(double dt) {
         hscroll -= inertial_speed.x * dt;
     }
 
+    if (inertial_speed.length() == 0) {
+        set_process(false);
+    }
+
+    apply_scroll();
+}
+
+void ScrollContainer::apply_scroll() {
+    if (children.empty() || !children.front()->is_ui_node()) {
+        return;
+    }
+
     vscroll = std::max(0.0f, vscroll);
     hscroll = std::max(0.0f, hscroll);
 
@@ -178,6 +196,9 @@ void ScrollContainer::update(double dt) {
     auto content = (NodeUi *)children.front().get();
 
     content->set_position({-hscroll, -vscroll});
+
+    // The scroll bars move along.
+    queue_redraw();
 }
 
 void ScrollContainer::draw_scroll_bar() {
@@ -195,21 +216,23 @@ void ScrollContainer::draw_scroll_bar() {
 
     auto vector_server = VectorServer::get_singleton();
 
-    auto global_pos = get_global_position();
     auto size = get_size();
 
     float bar_width = 4.0;
 
+    // Draw in local space.
+    vector_server->push_transform(Transform2::from_translation(get_global_position()));
+
     // Vertical.
     if (content_size.y > size.y) {
-        auto scroll_bar_pos = Vec2F(size.x - bar_width, 0) + global_pos;
+        auto scroll_bar_pos = Vec2F(size.x - bar_width, 0);
         auto scroll_bar_size = Vec2F(bar_width, size.y);
 
         vector_server->draw_style_box(theme_scroll_bar, scroll_bar_pos, scroll_bar_size);
 
         auto grabber_length = size.y / content_size.y * size.y;
 
-        auto grabber_pos = Vec2F(size.x - bar_width, size.y / content_size.y * vscroll) + global_pos;
+        auto grabber_pos = Vec2F(size.x - bar_width, size.y / content_size.y * vscroll);
         auto grabber_size = Vec2F(bar_width, grabber_length);
 
         vector_server->draw_style_box(theme_scroll_grabber, grabber_pos, grabber_size);
@@ -217,18 +240,20 @@ void ScrollContainer::draw_scroll_bar() {
 
     // Horizontal.
     if (content_size.x > size.x) {
-        auto scroll_bar_pos = Vec2F(0, size.y - bar_width) + global_pos;
+        auto scroll_bar_pos = Vec2F(0, size.y - bar_width);
         auto scroll_bar_size = Vec2F(size.x, bar_width);
 
         vector_server->draw_style_box(theme_scroll_bar, scroll_bar_pos, scroll_bar_size);
 
         auto grabber_length = size.x / content_size.x * size.x;
 
-        auto grabber_pos = Vec2F(size.x / content_size.x * hscroll, size.y - bar_width) + global_pos;
+        auto grabber_pos = Vec2F(size.x / content_size.x * hscroll, size.y - bar_width);
         auto grabber_size = Vec2F(grabber_length, bar_width);
 
         vector_server->draw_style_box(theme_scroll_grabber, grabber_pos, grabber_size);
     }
+
+    vector_server->pop_transform();
 }
 
 void ScrollContainer::set_hscroll(int32_t value) {
@@ -237,6 +262,7 @@ void ScrollContainer::set_hscroll(int32_t value) {
     }
 
     hscroll = value;
+    apply_scroll();
 }
 
 int32_t ScrollContainer::get_hscroll() const {
@@ -249,6 +275,7 @@ void ScrollContainer::set_vscroll(int32_t value) {
     }
 
     vscroll = value;
+    apply_scroll();
 }
 
 int32_t ScrollContainer::get_vscroll() const {
@@ -257,14 +284,30 @@ int32_t ScrollContainer::get_vscroll() const {
 
 void ScrollContainer::enable_hscroll(bool enabled) {
     hscroll_enabled = enabled;
+    update_layout_boundary();
+    queue_relayout();
 }
 
 void ScrollContainer::enable_vscroll(bool enabled) {
     vscroll_enabled = enabled;
+    update_layout_boundary();
+    queue_relayout();
+}
+
+void ScrollContainer::update_layout_boundary() {
+    // Scrolling in both directions, the minimum size doesn't depend on the content.
+    set_kind(NodeKind::LayoutBoundary, hscroll_enabled && vscroll_enabled);
 }
 
 void ScrollContainer::set_size(Vec2F new_size) {
+    if (size == new_size) {
+        return;
+    }
+
     size = new_size;
+
+    // Scroll range changed.
+    queue_relayout();
 }
 
 void ScrollContainer::pre_draw_children() {
@@ -278,7 +321,7 @@ void ScrollContainer::pre_draw_children() {
     }
 
     auto global_pos = get_global_position();
-    float dpi_scale = RenderServer::get_singleton()->window_builder_->get_dpi_scaling_factor(get_window_index());
+    float dpi_scale = RenderServer::get_singleton()->get_dpi_scaling_factor(get_window_index());
     auto size = get_size() * dpi_scale;
 
     auto vector_server = VectorServer::get_singleton();
@@ -292,7 +335,10 @@ void ScrollContainer::pre_draw_children() {
     temp_draw_data.render_target_id = canvas->get_scene()->push_render_target(render_target_desc);
 
     // For the temporary render target, we need to offset all child nodes back to the origin.
-    vector_server->global_transform_offset = Transform2::from_translation(-global_pos);
+    vector_server->push_target_origin(global_pos);
+
+    // The render target discards whatever crosses the edge, but children entirely outside needn't be drawn at all.
+    vector_server->push_clip_rect(RectF(global_pos, global_pos + get_size()), true);
 }
 
 void ScrollContainer::post_draw_children() {
@@ -307,15 +353,16 @@ void ScrollContainer::post_draw_children() {
 
     auto canvas = vector_server->get_canvas();
 
+    vector_server->pop_clip_rect();
+    vector_server->pop_transform();
+
     // Don't draw on the temporary render target anymore.
     canvas->get_scene()->pop_render_target();
 
-    float dpi_scale = RenderServer::get_singleton()->window_builder_->get_dpi_scaling_factor(get_window_index());
-
-    auto dst_rect = RectF(global_pos * dpi_scale, (global_pos + size) * dpi_scale);
+    // Relative to whatever we're drawing into.
+    auto dst_rect = vector_server->get_global_to_target() * RectF(global_pos, global_pos + size);
     canvas->draw_render_target(temp_draw_data.render_target_id, dst_rect);
 
-    vector_server->global_transform_offset = Transform2();
     draw_scroll_bar();
 }
 
@@ -39,6 +39,11 @@ public:
     void enable_vscroll(bool enabled);
 
 protected:
+    /// Clamp scroll values and move the content accordingly.
+    void apply_scroll();
+
+    void update_layout_boundary();
+
     bool hscroll_enabled = true;
     bool vscroll_enabled = true;
 
@@ -26,7 +26,7 @@ void SplitContainer::adjust_layout() {
         }
 
         if (child->is_ui_node() && child->get_visibility()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             auto child_min_size = cast_child->get_effective_minimum_size();
 
             if (valid_count == 0) {
@@ -58,7 +58,7 @@ void SplitContainer::adjust_layout() {
         }
 
         if (child->is_ui_node() && child->get_visibility()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
 
             float grabber_left_edge_pos = size.x - split_to_right_length - effective_grabber_size * 0.5f;
 
@@ -104,7 +104,7 @@ void SplitContainer::calc_minimum_size() {
 
     for (const auto &child : children) {
         if (child->is_ui_node() && child->get_visibility() && valid_count < 2) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             auto child_min_size = cast_child->get_effective_minimum_size();
             min_size += child_min_size;
         }
@@ -115,15 +115,11 @@ void SplitContainer::calc_minimum_size() {
     calculated_minimum_size = min_size;
 }
 
-void SplitContainer::update(const double dt) {
-    Container::update(dt);
-
-    adjust_layout();
-}
-
 void SplitContainer::input(InputEvent &event) {
     const auto global_position = get_global_position();
 
+    const bool was_dragging = grabber_pressed_pos_.has_value();
+
     bool consume_flag = false;
 
     if (splitting_enabled_) {
@@ -152,8 +148,14 @@ void SplitContainer::input(InputEvent &event) {
             }
 
             if (grabber_pressed_pos_.has_value()) {
-                split_to_right_length =
+                auto new_split_to_right_length =
                     size.x - (args.position.x - global_position.x - grabber_pressed_offset.x + grabber_size_ * 0.5f);
+
+                // Clamped to the children's minimum sizes by adjust_layout().
+                if (new_split_to_right_length != split_to_right_length) {
+                    split_to_right_length = new_split_to_right_length;
+                    queue_relayout();
+                }
             }
         }
 
@@ -181,6 +183,10 @@ void SplitContainer::input(InputEvent &event) {
         }
     }
 
+    if (grabber_pressed_pos_.has_value() != was_dragging) {
+        queue_redraw();
+    }
+
     NodeUi::input(event);
 
     if (consume_flag) {
@@ -212,10 +218,12 @@ void SplitContainer::draw() {
 
 void SplitContainer::set_separation(const float new_separation) {
     grabber_size_ = new_separation;
+    queue_relayout();
 }
 
 void SplitContainer::set_split_ratio(const float new_ratio) {
     split_to_right_length = (1.0f - new_ratio) * size.x;
+    queue_relayout();
 }
 
 } // namespace vecgui
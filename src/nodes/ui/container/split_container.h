@@ -13,8 +13,6 @@ class SplitContainer : public Container {
 public:
     SplitContainer();
 
-    void update(double dt) override;
-
     void draw() override;
 
     void calc_minimum_size() override;
@@ -10,11 +10,11 @@ TabContainer::TabContainer() {
 
     auto default_theme = DefaultResource::get_singleton()->get_default_theme();
 
-    button_scroll_container = std::make_shared<ScrollContainer>();
+    button_scroll_container = make_node<ScrollContainer>();
     button_scroll_container->enable_vscroll(false);
     add_embedded_child(button_scroll_container);
 
-    button_container = std::make_shared<HBoxContainer>();
+    button_container = make_node<HBoxContainer>();
     button_scroll_container->add_child(button_container);
 
     tab_button_group = std::make_shared<ToggleButtonGroup>();
@@ -41,7 +41,7 @@ void TabContainer::adjust_layout() {
             children[i]->set_visibility(should_be_visible);
         }
 
-        auto ui_child = dynamic_cast<NodeUi *>(children[i].get());
+        auto ui_child = static_cast<NodeUi *>(children[i].get());
         ui_child->set_position({0, tab_button_height});
         ui_child->set_size({size.x, size.y - tab_button_height});
     }
@@ -61,7 +61,7 @@ void TabContainer::calc_minimum_size() {
             continue;
         }
 
-        auto cast_child = dynamic_cast<NodeUi *>(child.get());
+        auto cast_child = static_cast<NodeUi *>(child.get());
         auto child_min_size = cast_child->get_effective_minimum_size();
 
         min_size = min_size.max(child_min_size);
@@ -133,7 +133,7 @@ void TabContainer::reload_tab_buttons() {
     tab_button_group->clear_buttons();
 
     for (int idx = 0; idx < children.size(); idx++) {
-        auto button = std::make_shared<Button>();
+        auto button = make_node<Button>();
         button->set_pressed_style_to_toggled(true);
 
         if (children[idx]->name.empty()) {
@@ -151,7 +151,7 @@ void TabContainer::reload_tab_buttons() {
                 current_tab = idx;
             }
         };
-        button->connect_signal("toggled", callback);
+        button->signal_toggled.connect(callback);
         button->set_toggle_mode(true);
     }
 }
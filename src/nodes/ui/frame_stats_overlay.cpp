@@ -0,0 +1,77 @@
+#include "frame_stats_overlay.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "../../servers/engine.h"
+
+namespace vecgui {
+
+FrameStatsOverlay::FrameStatsOverlay() {
+    type = NodeType::FrameStatsOverlay;
+
+    theme_bg = std::optional(StyleBox());
+    theme_bg->bg_color = ColorU(0, 0, 0, 160);
+    theme_bg->corner_radius = 4;
+
+    set_mouse_filter(MouseFilter::Ignore);
+
+    label = make_node<Label>();
+    label->set_mouse_filter(MouseFilter::Ignore);
+    label->set_multi_line(true);
+    label->set_font_size(12);
+    label->set_anchor_flag(AnchorFlag::FullRect);
+
+    add_embedded_child(label);
+
+    set_refresh_interval(refresh_interval_);
+}
+
+FrameStatsOverlay::~FrameStatsOverlay() {
+    TimerServer::get_singleton()->stop(refresh_timer_id);
+}
+
+void FrameStatsOverlay::draw() {
+    if (!visible_) {
+        return;
+    }
+
+    if (theme_bg.has_value()) {
+        VectorServer::get_singleton()->draw_style_box(theme_bg.value(), get_global_position(), size);
+    }
+}
+
+void FrameStatsOverlay::calc_minimum_size() {
+    calculated_minimum_size = label->get_effective_minimum_size();
+}
+
+void FrameStatsOverlay::set_size(Vec2F new_size) {
+    NodeUi::set_size(new_size);
+    label->set_size(size);
+}
+
+void FrameStatsOverlay::set_refresh_interval(double interval) {
+    refresh_interval_ = interval;
+
+    TimerServer::get_singleton()->stop(refresh_timer_id);
+    refresh_timer_id = TimerServer::get_singleton()->start(0, [this] { refresh(); }, refresh_interval_);
+}
+
+void FrameStatsOverlay::refresh() {
+    auto engine = Engine::get_singleton();
+    auto stats = engine->get_frame_time_stats();
+
+    auto ms = [](double seconds) { return seconds * 1000.0; };
+
+    std::ostringstream string_stream;
+    string_stream << std::fixed << std::setprecision(1);
+    string_stream << "FPS " << engine->get_fps() << "\n";
+    string_stream << "p50 " << ms(stats.p50) << " ms, p90 " << ms(stats.p90) << " ms\n";
+    string_stream << "p99 " << ms(stats.p99) << " ms, max " << ms(stats.max) << " ms\n";
+    string_stream << "Over " << ms(engine->get_frame_budget()) << " ms: " << stats.over_budget_count << "/"
+                  << stats.frame_count;
+
+    label->set_text(string_stream.str());
+}
+
+} // namespace vecgui
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <optional>
+
+#include "../../resources/style_box.h"
+#include "../../servers/timer_server.h"
+#include "label.h"
+#include "node_ui.h"
+
+namespace vecgui {
+
+/// Shows FPS and frame time percentiles from the engine. The text is only refreshed periodically,
+/// so the overlay doesn't reshape text or process every frame.
+class FrameStatsOverlay : public NodeUi {
+public:
+    FrameStatsOverlay();
+
+    ~FrameStatsOverlay() override;
+
+    void draw() override;
+
+    void calc_minimum_size() override;
+
+    void set_size(Vec2F new_size) override;
+
+    /// In seconds.
+    void set_refresh_interval(double interval);
+
+protected:
+    void refresh();
+
+    std::optional<StyleBox> theme_bg;
+
+    std::shared_ptr<Label> label;
+
+    TimerId refresh_timer_id{};
+
+    double refresh_interval_ = 0.5;
+};
+
+} // namespace vecgui
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "../../resources/default_resource.h"
+#include "../../servers/profiler.h"
 
 // See https://www.freetype.org/freetype2/docs/glyphs/glyphs-3.html for glyph conventions.
 
@@ -334,6 +335,9 @@ std::vector<LayoutGlyph> convert_to_in_context_glyphs(const std::vector<Glyph> &
 }
 
 void Label::measure() {
+    VECGUI_PROFILE_ZONE("Shape");
+    VECGUI_PROFILE_COUNT(type, Reshapes);
+
     font->get_glyphs(text_, font_size_, glyphs_, paragraphs_);
 
     // Add emoji data.
@@ -505,6 +509,7 @@ void Label::update(double dt) {
 
 void Label::set_text_style(TextStyle _text_style) {
     text_style = _text_style;
+    queue_redraw();
 }
 
 void Label::draw() {
@@ -527,14 +532,19 @@ void Label::draw() {
 
     auto translation = Transform2::from_translation(global_position + alignment_shift);
 
-    RectF clip_box;
-    //    if (clip) {
-    //        clip_box = {{}, size};
-    //    } else {
-    //        clip_box = {{}, calc_minimum_size()};
-    //    }
+    if (clip) {
+        vector_server->push_clip_rect(RectF(global_position, global_position + size));
+    }
+
+    vector_server->draw_glyphs(glyphs_, glyph_positions, text_style, translation, RectF(), alpha);
+
+    if (clip) {
+        vector_server->pop_clip_rect();
+    }
+}
 
-    vector_server->draw_glyphs(glyphs_, glyph_positions, text_style, translation, clip_box, alpha);
+void Label::set_clip(bool enabled) {
+    clip = enabled;
 }
 
 void Label::set_horizontal_alignment(Alignment alignment) {
@@ -89,6 +89,13 @@ public:
 
     void set_multi_line(bool enabled);
 
+    /// Hide text outside the label's rect.
+    void set_clip(bool enabled);
+
+    bool get_clip() const {
+        return clip;
+    }
+
     std::optional<StyleBox> theme_override_bg;
     std::optional<TextStyle> theme_override_text_style;
     TextStyle text_style;
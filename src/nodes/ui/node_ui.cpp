@@ -10,6 +10,7 @@ namespace vecgui {
 
 NodeUi::NodeUi() {
     type = NodeType::NodeUi;
+    set_kind(NodeKind::Ui, true);
 }
 
 void NodeUi::calc_minimum_size() {
@@ -21,18 +22,45 @@ void NodeUi::adjust_layout() {
 }
 
 void NodeUi::queue_relayout() {
-    if (layout_is_dirty) {
+    queue_redraw();
+
+    // Ancestors of a dirty node are dirty too, unless the node is a layout boundary dirtied from inside.
+    if (layout_is_dirty && !layout_dirty_inside_only) {
         return;
     }
 
     layout_is_dirty = true;
+    layout_dirty_inside_only = false;
+
+    // The parent is outside the subtree of the current worker.
+    auto walks = get_deferred_ancestor_walks();
+    if (walks && walks->root == this) {
+        walks->relayouts.push_back(this);
+        return;
+    }
+
+    queue_parent_relayout();
+}
 
+void NodeUi::queue_parent_relayout() {
     if (parent && parent->is_ui_node()) {
-        auto ui_parent = dynamic_cast<NodeUi *>(parent);
-        ui_parent->queue_relayout();
+        auto ui_parent = static_cast<NodeUi *>(parent);
+        ui_parent->queue_relayout_from_child();
     }
 }
 
+void NodeUi::queue_relayout_from_child() {
+    if (is_kind(NodeKind::LayoutBoundary)) {
+        if (!layout_is_dirty) {
+            layout_is_dirty = true;
+            layout_dirty_inside_only = true;
+        }
+        return;
+    }
+
+    queue_relayout();
+}
+
 Vec2F NodeUi::get_effective_minimum_size() const {
     // Take both custom_minimum_size and calculated_minimum_size into account.
     return custom_minimum_size.max(calculated_minimum_size);
@@ -115,8 +143,61 @@ Vec2F NodeUi::get_global_position() const {
     return calculated_global_position;
 }
 
-void NodeUi::calc_global_position(Vec2F parent_global_position) {
-    calculated_global_position = parent_global_position + position;
+Transform2 NodeUi::get_global_transform() const {
+    return calculated_global_transform;
+}
+
+void NodeUi::calc_global_transform(const NodeUi *ui_parent) {
+    auto local_transform = Transform2::from_translation(position);
+
+    // Most UI nodes are neither rotated nor scaled.
+    if (has_rotation_or_scale()) {
+        local_transform = local_transform * Transform2::from_translation(pivot_offset) *
+                          Transform2::from_rotation(rotation) * Transform2::from_scale(scale) *
+                          Transform2::from_translation(-pivot_offset);
+    }
+
+    if (ui_parent) {
+        calculated_global_transform = ui_parent->calculated_global_transform * local_transform;
+        calculated_global_position = ui_parent->calculated_global_position + position;
+        calculated_transformed = ui_parent->calculated_transformed || has_rotation_or_scale();
+    } else {
+        calculated_global_transform = local_transform;
+        calculated_global_position = position;
+        calculated_transformed = has_rotation_or_scale();
+    }
+
+    transform_is_dirty = false;
+}
+
+Transform2 NodeUi::get_view_transform() const {
+    auto pivot = calculated_global_position + pivot_offset;
+
+    return Transform2::from_translation(pivot) * Transform2::from_rotation(rotation) * Transform2::from_scale(scale) *
+           Transform2::from_translation(-pivot);
+}
+
+RectF NodeUi::get_global_bounds() const {
+    if (!calculated_transformed) {
+        return {calculated_global_position, calculated_global_position + size};
+    }
+
+    return calculated_global_transform * RectF({}, size);
+}
+
+Vec2F NodeUi::window_to_global(Vec2F window_point) const {
+    if (!calculated_transformed) {
+        return window_point;
+    }
+
+    return calculated_global_transform.inverse() * window_point + calculated_global_position;
+}
+
+void NodeUi::queue_retransform() {
+    queue_redraw();
+
+    transform_is_dirty = true;
+    propagate_transform_pending();
 }
 
 void NodeUi::set_mouse_filter(MouseFilter filter) {
@@ -124,7 +205,65 @@ void NodeUi::set_mouse_filter(MouseFilter filter) {
 }
 
 void NodeUi::set_position(Vec2F new_position) {
+    if (position == new_position) {
+        return;
+    }
+
     position = new_position;
+    queue_retransform();
+}
+
+void NodeUi::set_scale(Vec2F new_scale) {
+    if (scale == new_scale) {
+        return;
+    }
+
+    bool was_rotated_or_scaled = has_rotation_or_scale();
+
+    scale = new_scale;
+    queue_retransform();
+
+    // Overflowing subtrees are found again, see NodeTable::subtree_overflows.
+    if (has_rotation_or_scale() != was_rotated_or_scaled) {
+        queue_node_table_rebuild();
+    }
+}
+
+Vec2F NodeUi::get_scale() const {
+    return scale;
+}
+
+void NodeUi::set_rotation(float new_rotation) {
+    if (rotation == new_rotation) {
+        return;
+    }
+
+    bool was_rotated_or_scaled = has_rotation_or_scale();
+
+    rotation = new_rotation;
+    queue_retransform();
+
+    // Overflowing subtrees are found again, see NodeTable::subtree_overflows.
+    if (has_rotation_or_scale() != was_rotated_or_scaled) {
+        queue_node_table_rebuild();
+    }
+}
+
+float NodeUi::get_rotation() const {
+    return rotation;
+}
+
+void NodeUi::set_pivot_offset(Vec2F new_pivot_offset) {
+    if (pivot_offset == new_pivot_offset) {
+        return;
+    }
+
+    pivot_offset = new_pivot_offset;
+    queue_retransform();
+}
+
+Vec2F NodeUi::get_pivot_offset() const {
+    return pivot_offset;
 }
 
 void NodeUi::set_size(Vec2F new_size) {
@@ -139,7 +278,7 @@ void NodeUi::set_size(Vec2F new_size) {
     // to re-evaluate their anchors and internal layouts.
     for (auto &child : get_all_children()) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             cast_child->queue_relayout();
         }
     }
@@ -170,16 +309,18 @@ Vec2F NodeUi::get_local_mouse_position() const {
 }
 
 void NodeUi::grab_focus() {
+    if (!focused) {
+        queue_redraw();
+    }
+
     focused = true;
 }
 
 void NodeUi::release_focus() {
-    for (auto &callback : callbacks_focus_released) {
-        try {
-            callback();
-        } catch (std::bad_any_cast &) {
-            Logger::error("Mismatched signal argument types!");
-        }
+    signal_focus_released.emit();
+
+    if (focused) {
+        queue_redraw();
     }
 
     focused = false;
@@ -187,7 +328,7 @@ void NodeUi::release_focus() {
 
 ColorU NodeUi::get_global_modulate() {
     if (parent && parent->is_ui_node()) {
-        auto cast_parent = dynamic_cast<NodeUi *>(parent);
+        auto cast_parent = static_cast<NodeUi *>(parent);
         return ColorU(modulate.to_f32() * cast_parent->get_global_modulate().to_f32());
     } else {
         return ColorU::white();
@@ -204,7 +345,8 @@ bool NodeUi::is_inside_container() const {
             case NodeType::HBoxContainer:
             case NodeType::VBoxContainer:
             case NodeType::ScrollContainer:
-            case NodeType::TabContainer: {
+            case NodeType::TabContainer:
+            case NodeType::CachedLayer: {
                 return true;
             }
             default:
@@ -219,7 +361,7 @@ Vec2F NodeUi::get_max_child_min_size() const {
 
     for (auto &child : children) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             max_child_min_size = max_child_min_size.max(cast_child->get_effective_minimum_size());
         }
     }
@@ -236,17 +378,16 @@ void NodeUi::apply_anchor() {
 
     // If it has no parent or the parent is not a UI node, use the parent window's size for anchoring.
     if (parent && parent->is_ui_node()) {
-        auto ui_parent = dynamic_cast<NodeUi *>(parent);
+        auto ui_parent = static_cast<NodeUi *>(parent);
         parent_size = ui_parent->get_size();
     } else {
-        auto render_server = RenderServer::get_singleton();
-        auto window = render_server->window_builder_->get_window(get_window_index());
-
-        parent_size = window.lock()->get_logical_size().to_f32();
+        parent_size = RenderServer::get_singleton()->get_window_logical_size(get_window_index()).to_f32();
     }
 
     auto actual_size = get_effective_minimum_size().max(size);
 
+    auto old_position = position;
+
     float center_x = (parent_size.x - actual_size.x) * 0.5f;
     float center_y = (parent_size.y - actual_size.y) * 0.5f;
     float right = parent_size.x - actual_size.x;
@@ -315,18 +456,20 @@ void NodeUi::apply_anchor() {
             abort();
         }
     }
+
+    if (position != old_position) {
+        queue_retransform();
+    }
 }
 
 void NodeUi::cursor_entered() {
-    for (auto &callback : callbacks_cursor_entered) {
-        callback();
-    }
+    queue_redraw();
+    signal_cursor_entered.emit();
 }
 
 void NodeUi::cursor_exited() {
-    for (auto &callback : callbacks_cursor_exited) {
-        callback();
-    }
+    queue_redraw();
+    signal_cursor_exited.emit();
 }
 
 void NodeUi::set_anchor_flag(AnchorFlag anchor_flag) {
@@ -346,7 +489,7 @@ void NodeUi::when_parent_size_changed(Vec2F new_size) {
     queue_relayout();
     for (auto &child : get_all_children()) {
         if (child->is_ui_node()) {
-            auto cast_child = dynamic_cast<NodeUi *>(child.get());
+            auto cast_child = static_cast<NodeUi *>(child.get());
             cast_child->when_parent_size_changed(size);
         }
     }
@@ -356,7 +499,7 @@ void NodeUi::connect_signal(const std::string &signal, const AnyCallable<void> &
     Node::connect_signal(signal, callback);
 
     if (signal == "focus_released") {
-        callbacks_focus_released.push_back(callback);
+        connect_any_callable(signal_focus_released, callback);
     }
 }
 
@@ -76,6 +76,9 @@ struct ContainerSizing {
 };
 
 class NodeUi : public Node {
+    friend class Node;
+    friend struct NodeTable;
+
 public:
     NodeUi();
 
@@ -108,15 +111,60 @@ public:
 
     void clear_layout_dirty() {
         layout_is_dirty = false;
+        layout_dirty_inside_only = false;
     }
 
-    bool is_ui_node() const override {
-        return true;
+    void set_scale(Vec2F new_scale);
+
+    Vec2F get_scale() const;
+
+    /// In radians, around the pivot. Mouse input is mapped back, so widgets behave the same. ScrollContainers
+    /// composite their content through an axis-aligned render target though, so don't rotate them or their ancestors.
+    void set_rotation(float new_rotation);
+
+    float get_rotation() const;
+
+    /// Relative to the top-left corner. Rotation and scale are around it.
+    void set_pivot_offset(Vec2F new_pivot_offset);
+
+    Vec2F get_pivot_offset() const;
+
+    /// Mark the global transform of this node (and so that of its UI descendants) as outdated.
+    void queue_retransform();
+
+    bool is_transform_dirty() const {
+        return transform_is_dirty;
     }
 
+    /// Where the node draws and tests input, the sum of the positions up to the root. Rotation and scale are applied
+    /// on top of it, see is_transformed().
     Vec2F get_global_position() const;
 
-    void calc_global_position(Vec2F parent_global_position);
+    /// From the local space of the node to its window, with the rotation and scale of the node and its ancestors.
+    Transform2 get_global_transform() const;
+
+    /// Combine the global transform of the parent, if any, with the position, rotation and scale.
+    void calc_global_transform(const NodeUi *ui_parent);
+
+    bool has_rotation_or_scale() const {
+        return rotation != 0 || scale != Vec2F(1);
+    }
+
+    /// If this node or a UI ancestor is rotated or scaled, so it's not drawn axis-aligned at its global position.
+    bool is_transformed() const {
+        return calculated_transformed;
+    }
+
+    /// What the node's rotation and scale do to points around its global position, for drawing, see
+    /// VectorServer::push_view_transform(). Ancestors' are applied by themselves.
+    Transform2 get_view_transform() const;
+
+    /// Axis-aligned bounds of the node's rect in its window.
+    RectF get_global_bounds() const;
+
+    /// Map a point of the window, e.g. of a mouse event, to where the node draws and tests input, undoing the
+    /// rotation and scale of the node and its ancestors.
+    Vec2F window_to_global(Vec2F window_point) const;
 
     virtual bool ignore_mouse_input_outside_rect() const {
         return false;
@@ -126,6 +174,14 @@ public:
 
     void set_mouse_filter(MouseFilter filter);
 
+    bool is_hovered() const {
+        return is_cursor_inside;
+    }
+
+    bool has_focus() const {
+        return focused;
+    }
+
     ContainerSizing container_sizing{};
 
     Vec2F get_local_mouse_position() const;
@@ -164,6 +220,11 @@ public:
 
     std::optional<StyleBox> debug_box;
 
+    // Signals.
+    Signal<> signal_cursor_entered;
+    Signal<> signal_cursor_exited;
+    Signal<> signal_focus_released;
+
 protected:
     Vec2F position{0};
     Vec2F size{16, 16};
@@ -173,8 +234,17 @@ protected:
 
     Vec2F calculated_global_position{0};
 
+    Transform2 calculated_global_transform;
+
+    bool calculated_transformed = false;
+
     bool layout_is_dirty = true;
 
+    /// Dirtied by a child of a layout boundary, so the parent doesn't know.
+    bool layout_dirty_inside_only = false;
+
+    bool transform_is_dirty = true;
+
     bool focused = false;
 
     bool is_pressed_inside = false;
@@ -196,6 +266,11 @@ protected:
 
     void input(InputEvent &input_event) override;
 
+    void queue_relayout_from_child();
+
+    /// The part of queue_relayout() walking up the tree.
+    void queue_parent_relayout();
+
     void cursor_entered();
 
     void cursor_exited();
@@ -204,10 +279,6 @@ protected:
 
     MouseFilter mouse_filter = MouseFilter::Stop;
 
-    std::vector<AnyCallable<void>> callbacks_cursor_entered;
-    std::vector<AnyCallable<void>> callbacks_cursor_exited;
-    std::vector<AnyCallable<void>> callbacks_focus_released;
-    std::vector<AnyCallable<void>> callbacks_parent_size_changed;
 };
 
 } // namespace vecgui
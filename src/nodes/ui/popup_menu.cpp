@@ -10,17 +10,18 @@ namespace vecgui {
 
 PopupMenu::PopupMenu() {
     type = NodeType::PopupMenu;
+    set_kind(NodeKind::Popup, true);
 
-    margin_container_ = std::make_shared<MarginContainer>();
+    margin_container_ = make_node<MarginContainer>();
     margin_container_->name = "PopupMenu embedded margin container";
     margin_container_->set_anchor_flag(AnchorFlag::FullRect);
     add_embedded_child(margin_container_);
 
-    scroll_container_ = std::make_shared<ScrollContainer>();
+    scroll_container_ = make_node<ScrollContainer>();
     scroll_container_->enable_hscroll(false);
     margin_container_->add_child(scroll_container_);
 
-    vbox_container_ = std::make_shared<VBoxContainer>();
+    vbox_container_ = make_node<VBoxContainer>();
     vbox_container_->set_mouse_filter(MouseFilter::Pass);
     scroll_container_->add_child(vbox_container_);
 }
@@ -84,18 +85,19 @@ void PopupMenu::set_visibility(bool visible) {
 
     visible_ = visible;
 
+    queue_redraw();
+
     if (visible_) {
         calc_minimum_size();
 
-        auto render_server = RenderServer::get_singleton();
-        auto window = render_server->window_builder_->get_window(get_window_index());
+        auto window_size = RenderServer::get_singleton()->get_window_logical_size(get_window_index());
 
         // We updated its global position in MenuButton before calling set_visibility.
         auto global_position = popup_position;
 
         float menu_width = std::max(size.x, margin_container_->get_effective_minimum_size().x);
         float menu_top_space = global_position.y;
-        float menu_bottom_space = window.lock()->get_logical_size().y - global_position.y - button_height;
+        float menu_bottom_space = window_size.y - global_position.y - button_height;
 
         float min_menu_height = vbox_container_->get_effective_minimum_size().y + margin_container_->get_margin().top +
                                 margin_container_->get_margin().bottom + 2; // 2 comes from the glitch margin container.
@@ -139,7 +141,7 @@ void PopupMenu::set_popup_position(Vec2F new_position, float new_button_height)
 }
 
 void PopupMenu::create_item(const std::string &text) {
-    auto new_item = std::make_shared<Button>();
+    auto new_item = make_node<Button>();
     new_item->set_mouse_filter(MouseFilter::Pass);
     new_item->set_text(text);
 
@@ -165,7 +167,7 @@ void PopupMenu::set_item_meta(uint32_t item_index, std::string meta) {
 
 void PopupMenu::set_item_height(float new_item_height) {
     item_height_ = new_item_height;
-    // TODO
+    queue_relayout();
 }
 
 float PopupMenu::get_item_height() const {
@@ -18,7 +18,7 @@ ProgressBar::ProgressBar() {
     theme_fg->border_width = 2;
 
     // Don't add the label as a child since it's not a normal node but part of the button.
-    label = std::make_shared<Label>();
+    label = make_node<Label>();
     label->set_text("");
     label->set_mouse_filter(MouseFilter::Ignore);
     label->set_horizontal_alignment(Alignment::Center);
@@ -42,13 +42,21 @@ void ProgressBar::update(double dt) {
     if (lerp_enabled) {
         lerp_elapsed_ += dt;
         float t = std::clamp(lerp_elapsed_ / lerp_duration_, 0.0f, 1.0f);
-        value = Pathfinder::lerp(value, target_value, t);
+        float new_value = Pathfinder::lerp(value, target_value, t);
+
+        // Settled, nothing to redraw.
+        if (new_value == value) {
+            return;
+        }
+        value = new_value;
 
         ratio = (value - min_value) / (max_value - min_value);
 
         if (label_visible) {
             label->set_text(std::to_string((int)round(ratio * 100)) + "%");
         }
+
+        queue_redraw();
     }
 }
 
@@ -59,7 +67,7 @@ void ProgressBar::draw() {
 
     auto vector_server = VectorServer::get_singleton();
 
-    Vec2F start_pos = get_global_position();
+    Vec2F start_pos;
 
     switch (fill_mode_) {
         case FillMode::RightToLeft: {
@@ -73,8 +81,11 @@ void ProgressBar::draw() {
         } break;
     }
 
+    // Draw in local space.
+    vector_server->push_transform(Transform2::from_translation(get_global_position()));
+
     if (theme_bg.has_value()) {
-        vector_server->draw_style_box(theme_bg.value(), get_global_position(), size);
+        vector_server->draw_style_box(theme_bg.value(), {}, size);
     }
 
     if (theme_progress.has_value()) {
@@ -82,12 +93,14 @@ void ProgressBar::draw() {
     }
 
     if (theme_fg.has_value()) {
-        vector_server->draw_style_box(theme_fg.value(), get_global_position(), size);
+        vector_server->draw_style_box(theme_fg.value(), {}, size);
     }
+
+    vector_server->pop_transform();
 }
 
 void ProgressBar::set_position(Vec2F new_position) {
-    position = new_position;
+    NodeUi::set_position(new_position);
 }
 
 void ProgressBar::set_size(Vec2F new_size) {
@@ -108,6 +121,8 @@ void ProgressBar::set_value(float new_value) {
             label->set_text(std::to_string((int)round(ratio * 100)) + "%");
         }
     }
+
+    queue_redraw();
 }
 
 float ProgressBar::get_value() const {
@@ -116,6 +131,7 @@ float ProgressBar::get_value() const {
 
 void ProgressBar::set_min_value(float new_value) {
     min_value = new_value;
+    queue_redraw();
 }
 
 float ProgressBar::get_min_value() const {
@@ -124,6 +140,7 @@ float ProgressBar::get_min_value() const {
 
 void ProgressBar::set_max_value(float new_value) {
     max_value = new_value;
+    queue_redraw();
 }
 
 float ProgressBar::get_max_value() const {
@@ -157,6 +174,9 @@ void ProgressBar::set_label_font_size(float new_font_size) {
 
 void ProgressBar::set_lerp_enabled(bool new_lerp_enabled) {
     lerp_enabled = new_lerp_enabled;
+
+    // Only animate the value when needed.
+    set_process(lerp_enabled);
 }
 
 void ProgressBar::set_lerp_duration(float new_lerp_duration) {
@@ -165,6 +185,7 @@ void ProgressBar::set_lerp_duration(float new_lerp_duration) {
 
 void ProgressBar::set_fill_mode(FillMode new_fill_mode) {
     fill_mode_ = new_fill_mode;
+    queue_redraw();
 }
 
 } // namespace vecgui
@@ -22,7 +22,7 @@ void Slider::ready() {
 
     custom_ready();
 
-    callbacks_cursor_entered.emplace_back([this] {
+    signal_cursor_entered.connect([this] {
         hovered = true;
         InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::Hand);
 
@@ -31,7 +31,7 @@ void Slider::ready() {
         // }
     });
 
-    callbacks_cursor_exited.emplace_back([this] {
+    signal_cursor_exited.connect([this] {
         hovered = false;
         InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::Arrow);
 
@@ -44,6 +44,8 @@ void Slider::ready() {
 }
 
 void Slider::input(InputEvent &event) {
+    bool was_pressed = pressed;
+
     auto global_position = get_global_position();
 
     bool consume_flag = false;
@@ -90,6 +92,10 @@ void Slider::input(InputEvent &event) {
         }
     }
 
+    if (pressed != was_pressed) {
+        queue_redraw();
+    }
+
     NodeUi::input(event);
 
     if (consume_flag) {
@@ -108,23 +114,24 @@ void Slider::draw() {
 
     auto vector_server = VectorServer::get_singleton();
 
-    const auto global_position = get_global_position();
-
     auto default_theme = DefaultResource::get_singleton()->get_default_theme();
 
-    vector_server->draw_line(global_position + Vec2F(grabber_margin_, size.y * 0.5),
-                             global_position + Vec2F(size.x - grabber_margin_, size.y * 0.5),
+    // Draw in local space.
+    vector_server->push_transform(Transform2::from_translation(get_global_position()));
+
+    vector_server->draw_line(Vec2F(grabber_margin_, size.y * 0.5),
+                             Vec2F(size.x - grabber_margin_, size.y * 0.5),
                              4,
                              default_theme->slider.colors["unfilled"]);
 
     const float grabber_pos = ratio_ * (size.x - grabber_margin_ * 2) + grabber_margin_;
 
-    vector_server->draw_line(global_position + Vec2F(grabber_margin_, size.y * 0.5),
-                             global_position + Vec2F(grabber_pos, size.y * 0.5),
+    vector_server->draw_line(Vec2F(grabber_margin_, size.y * 0.5),
+                             Vec2F(grabber_pos, size.y * 0.5),
                              4,
                              default_theme->slider.colors["filled"]);
 
-    const Vec2F grabber_center = global_position + Vec2F(grabber_pos, size.y * 0.5);
+    const Vec2F grabber_center = Vec2F(grabber_pos, size.y * 0.5);
 
     if (pressed) {
         vector_server->draw_circle(grabber_center, 8, 0, true, default_theme->slider.colors["grabber_fill_pressed"]);
@@ -139,29 +146,25 @@ void Slider::draw() {
 
     vector_server->draw_circle(grabber_center, 8, 3, false, default_theme->slider.colors["grabber_border"]);
 
+    vector_server->pop_transform();
+
     NodeUi::draw();
 }
 
 void Slider::set_position(Vec2F new_position) {
-    position = new_position;
+    NodeUi::set_position(new_position);
 }
 
 void Slider::connect_signal(const std::string &signal, const AnyCallable<void> &callback) {
     NodeUi::connect_signal(signal, callback);
 
     if (signal == "value_changed") {
-        value_changed_callbacks.push_back(callback);
+        connect_any_callable(signal_value_changed, callback);
     }
 }
 
 void Slider::notify_value_changed(float new_value) {
-    for (auto &callback : value_changed_callbacks) {
-        try {
-            callback.operator()<float>(std::move(new_value));
-        } catch (std::bad_any_cast &) {
-            Logger::error("Mismatched signal argument types in Slider::notify_value_changed!", "revector");
-        }
-    }
+    signal_value_changed.emit(new_value);
 }
 
 void Slider::set_range(float start, float end) {
@@ -173,6 +176,8 @@ void Slider::set_range(float start, float end) {
         range_start_ = start;
         range_end_ = end;
     }
+
+    queue_redraw();
 }
 
 float Slider::get_value() const {
@@ -184,6 +189,8 @@ void Slider::set_value(float new_value) {
     new_value = std::clamp(new_value, range_start_, range_end_);
     ratio_ = (new_value - range_start_) / (range_end_ - range_start_);
     notify_value_changed(new_value);
+
+    queue_redraw();
 }
 
 void Slider::set_integer_mode(bool enabled) {
@@ -209,6 +216,8 @@ void Slider::change_ratio(float new_ratio) {
         notify_value_changed(get_value());
     }
     prev_value_ = new_value;
+
+    queue_redraw();
 }
 
 } // namespace vecgui
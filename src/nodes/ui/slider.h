@@ -37,6 +37,8 @@ public:
 
     void set_integer_mode(bool enabled);
 
+    Signal<float> signal_value_changed;
+
 protected:
     bool pressed = false;
     std::optional<Vec2F> pressed_position;
@@ -54,8 +56,6 @@ protected:
 
     float grabber_margin_ = 4.f;
 
-    std::vector<AnyCallable<void>> value_changed_callbacks;
-
     void change_ratio(float new_ratio);
 };
 
@@ -19,15 +19,15 @@ SpinBox::SpinBox() {
     theme_focused->border_width = 2;
 
     // Don't add the label as a child since it's not a normal node but part of the SpinBox.
-    label = std::make_shared<Label>();
+    label = make_node<Label>();
     label->set_mouse_filter(MouseFilter::Ignore);
     label->set_horizontal_alignment(Alignment::Center);
     label->set_vertical_alignment(Alignment::Center);
     set_value(0);
 
-    container_v = std::make_shared<VBoxContainer>();
+    container_v = make_node<VBoxContainer>();
 
-    container_h = std::make_shared<HBoxContainer>();
+    container_h = make_node<HBoxContainer>();
     container_h->add_child(label);
     container_h->add_child(container_v);
     container_h->set_separation(0);
@@ -41,6 +41,8 @@ void SpinBox::calc_minimum_size() {
 }
 
 void SpinBox::input(InputEvent &event) {
+    bool was_focused = focused;
+
     auto global_position = get_global_position();
     auto active_rect = RectF(global_position, global_position + size);
 
@@ -100,6 +102,10 @@ void SpinBox::input(InputEvent &event) {
     }
 
     NodeUi::input(event);
+
+    if (focused != was_focused) {
+        queue_redraw();
+    }
 }
 
 void SpinBox::update(double dt) {
@@ -127,7 +133,7 @@ void SpinBox::draw() {
 }
 
 void SpinBox::set_position(Vec2F p_position) {
-    position = p_position;
+    NodeUi::set_position(p_position);
 }
 
 void SpinBox::set_size(Vec2F p_size) {
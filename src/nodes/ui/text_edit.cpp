@@ -9,6 +9,9 @@
 
 namespace vecgui {
 
+/// Seconds between caret visibility toggles.
+constexpr double CARET_BLINK_INTERVAL = 0.6;
+
 std::string keep_numbers(const std::string &src) {
     std::string dst;
 
@@ -24,13 +27,13 @@ std::string keep_numbers(const std::string &src) {
 TextEdit::TextEdit() {
     type = NodeType::TextEdit;
 
-    label = std::make_shared<Label>();
+    label = make_node<Label>();
     label->set_horizontal_alignment(Alignment::Begin);
     label->set_vertical_alignment(Alignment::Center);
     label->set_mouse_filter(MouseFilter::Ignore);
     label->set_word_wrap(true);
 
-    margin_container = std::make_shared<MarginContainer>();
+    margin_container = make_node<MarginContainer>();
     margin_container->set_margin_all(4);
     margin_container->add_child(label);
     margin_container->set_mouse_filter(MouseFilter::Ignore);
@@ -40,13 +43,17 @@ TextEdit::TextEdit() {
 
     set_text("Enter text");
 
-    callbacks_cursor_entered.emplace_back(
+    signal_cursor_entered.connect(
         [this] { InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::IBeam); });
 
-    callbacks_cursor_exited.emplace_back(
+    signal_cursor_exited.connect(
         [this] { InputServer::get_singleton()->set_cursor(get_window_index(), CursorShape::Arrow); });
 }
 
+TextEdit::~TextEdit() {
+    stop_caret_blink();
+}
+
 void TextEdit::set_text(std::string new_text) const {
     if (numbers_only) {
         new_text = keep_numbers(new_text);
@@ -62,6 +69,12 @@ std::string TextEdit::get_text() const {
 void TextEdit::input(InputEvent &event) {
     auto input_server = InputServer::get_singleton();
 
+    // Text changes relayout the label, but the caret and selection are drawn by us.
+    bool was_focused = focused;
+    bool was_caret_visible = caret_visible;
+    auto previous_caret_index = current_caret_index;
+    auto previous_selection_start_index = selection_start_index;
+
     // Handle mouse input propagation.
     bool consume_flag = false;
 
@@ -102,7 +115,7 @@ void TextEdit::input(InputEvent &event) {
 
             if (is_pressed_inside) {
                 current_caret_index = calculate_caret_index(get_local_mouse_position());
-                caret_blink_timer = 0;
+                restart_caret_blink();
 
                 Logger::verbose("Caret position: current " + std::to_string(current_caret_index) + ", selected " +
                                     std::to_string(selection_start_index),
@@ -129,7 +142,7 @@ void TextEdit::input(InputEvent &event) {
 
                 current_caret_index++;
                 selection_start_index = current_caret_index;
-                caret_blink_timer = 0;
+                restart_caret_blink();
             }
 
             consume_flag = true;
@@ -151,7 +164,7 @@ void TextEdit::input(InputEvent &event) {
                             }
                         }
                     }
-                    caret_blink_timer = 0;
+                    restart_caret_blink();
                 }
             }
 
@@ -166,7 +179,7 @@ void TextEdit::input(InputEvent &event) {
                             }
                         }
                     }
-                    caret_blink_timer = 0;
+                    restart_caret_blink();
                 }
             }
 
@@ -180,7 +193,7 @@ void TextEdit::input(InputEvent &event) {
                         selection_start_index--;
                     }
 
-                    caret_blink_timer = 0;
+                    restart_caret_blink();
                 } else if (key_args.key == KeyCode::Right) {
                     if (current_caret_index != selection_start_index) {
                         current_caret_index = std::max(selection_start_index, current_caret_index);
@@ -190,7 +203,7 @@ void TextEdit::input(InputEvent &event) {
                         selection_start_index++;
                     }
 
-                    caret_blink_timer = 0;
+                    restart_caret_blink();
                 }
 
                 if (key_args.key == KeyCode::C && input_server->is_key_pressed(KeyCode::LeftControl)) {
@@ -232,17 +245,16 @@ void TextEdit::input(InputEvent &event) {
 
     NodeUi::input(event);
 
+    if (focused != was_focused || caret_visible != was_caret_visible || current_caret_index != previous_caret_index ||
+        selection_start_index != previous_selection_start_index) {
+        queue_redraw();
+    }
+
     if (consume_flag) {
         event.consumed = true;
     }
 }
 
-void TextEdit::update(double dt) {
-    NodeUi::update(dt);
-
-    caret_blink_timer += dt;
-}
-
 void TextEdit::draw() {
     auto vector_server = VectorServer::get_singleton();
 
@@ -281,7 +293,7 @@ void TextEdit::draw() {
 
     // Draw blinking caret.
     if (focused && editable) {
-        theme_caret.color.a_ = 255.0f * std::ceil(std::sin(caret_blink_timer * 5.0f));
+        theme_caret.color.a_ = caret_visible ? 255 : 0;
 
         float current_codepoint_right_edge = 0;
         if (current_caret_index > 0) {
@@ -342,10 +354,39 @@ Vec2F TextEdit::calculate_caret_position(int32_t target_caret_index) {
 
 void TextEdit::grab_focus() {
     focused = true;
+
+    restart_caret_blink();
 }
 
 void TextEdit::release_focus() {
     focused = false;
+
+    stop_caret_blink();
+}
+
+void TextEdit::restart_caret_blink() {
+    caret_visible = true;
+
+    // The caret only blinks when focused.
+    if (!focused) {
+        return;
+    }
+
+    stop_caret_blink();
+    caret_blink_timer_id = TimerServer::get_singleton()->start(
+        CARET_BLINK_INTERVAL,
+        [this] {
+            caret_visible = !caret_visible;
+            queue_redraw();
+        },
+        CARET_BLINK_INTERVAL);
+}
+
+void TextEdit::stop_caret_blink() {
+    if (caret_blink_timer_id) {
+        TimerServer::get_singleton()->stop(caret_blink_timer_id);
+        caret_blink_timer_id = {};
+    }
 }
 
 void TextEdit::set_editable(bool new_value) {
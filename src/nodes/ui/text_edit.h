@@ -6,6 +6,7 @@
 
 #include "../../common/geometry.h"
 #include "../../resources/style_box.h"
+#include "../../servers/timer_server.h"
 #include "label.h"
 
 namespace vecgui {
@@ -19,14 +20,14 @@ class TextEdit : public NodeUi {
 public:
     TextEdit();
 
+    ~TextEdit() override;
+
     void set_text(std::string new_text) const;
 
     std::string get_text() const;
 
     void input(InputEvent &event) override;
 
-    void update(double dt) override;
-
     void draw() override;
 
     void calc_minimum_size() override;
@@ -60,7 +61,14 @@ private:
     std::shared_ptr<MarginContainer> margin_container;
     std::shared_ptr<Label> label;
 
-    float caret_blink_timer = 0;
+    /// The caret is toggled by a repeating timer while focused.
+    bool caret_visible = true;
+    TimerId caret_blink_timer_id{};
+
+    /// Show the caret and blink from the start, e.g. after moving it.
+    void restart_caret_blink();
+
+    void stop_caret_blink();
 
     void delete_selection();
 
@@ -3,6 +3,7 @@
 #include <string>
 
 #include "../../common/utils.h"
+#include "../../resources/default_resource.h"
 #include "../scene_tree.h"
 
 namespace vecgui {
@@ -45,13 +46,13 @@ void Tree::input(InputEvent &event) {
 
 std::shared_ptr<TreeItem> Tree::create_item(const std::shared_ptr<TreeItem> &parent, const std::string &text) {
     if (parent == nullptr) {
-        root = std::make_shared<TreeItem>();
+        root = make_node<TreeItem>();
         root->tree = this;
         root->set_text(text);
         return root;
     }
 
-    auto item = std::make_shared<TreeItem>();
+    auto item = make_node<TreeItem>();
     item->tree = this;
     item->parent = parent.get();
     item->set_text(text);
@@ -62,6 +63,7 @@ std::shared_ptr<TreeItem> Tree::create_item(const std::shared_ptr<TreeItem> &par
 
 void Tree::set_item_height(float new_item_height) {
     item_height = new_item_height;
+    queue_relayout();
 }
 
 float Tree::get_item_height() {
@@ -77,18 +79,18 @@ void Tree::calc_minimum_size() {
 }
 
 TreeItem::TreeItem() {
-    label = std::make_shared<Label>();
+    label = make_node<Label>();
     label->container_sizing.flag_v = ContainerSizingFlag::Fill;
     label->set_vertical_alignment(Alignment::Center);
 
-    icon = std::make_shared<TextureRect>();
+    icon = make_node<TextureRect>();
     icon->set_custom_minimum_size({24, 24});
     icon->set_stretch_mode(TextureRect::StretchMode::KeepAspectCentered);
 
-    collapsed_tex = std::make_shared<VectorImage>(get_asset_dir("icons/ArrowRight.svg"));
-    expanded_tex = std::make_shared<VectorImage>(get_asset_dir("icons/ArrowDown.svg"));
+    collapsed_tex = DefaultResource::get_singleton()->get_icon("icons/ArrowRight.svg");
+    expanded_tex = DefaultResource::get_singleton()->get_icon("icons/ArrowDown.svg");
 
-    collapse_button = std::make_shared<Button>();
+    collapse_button = make_node<Button>();
     collapse_button->set_icon_normal(expanded_tex);
     collapse_button->set_text("");
     collapse_button->set_icon_expand(true);
@@ -107,9 +109,9 @@ TreeItem::TreeItem() {
             tree->queue_relayout();
         }
     };
-    collapse_button->connect_signal("triggered", callback);
+    collapse_button->signal_triggered.connect(callback);
 
-    container = std::make_shared<HBoxContainer>();
+    container = make_node<HBoxContainer>();
     container->set_separation(0);
     container->add_child(collapse_button);
     container->add_child(icon);
@@ -202,7 +204,7 @@ void TreeItem::propagate_draw_(float folding_width, uint32_t depth, float &offse
     dfs_postorder_ltr_traversal(container.get(), descendants);
     for (auto& node : descendants) {
         if (node->is_ui_node()) {
-            dynamic_cast<NodeUi*>(node)->calc_minimum_size();
+            static_cast<NodeUi *>(node)->calc_minimum_size();
         }
     }
 
@@ -215,7 +217,7 @@ void TreeItem::propagate_draw_(float folding_width, uint32_t depth, float &offse
     for (auto &node : nodes) {
         node->update(0);
         if (node->is_ui_node()) {
-            dynamic_cast<NodeUi *>(node)->clear_layout_dirty();
+            static_cast<NodeUi *>(node)->clear_layout_dirty();
         }
     }
 
@@ -269,6 +271,7 @@ void TreeItem::input(InputEvent &event, Vec2F global_position) {
             if (item_global_rect.contains_point(button_event.position)) {
                 selected = true;
                 tree->selected_item = this;
+                tree->queue_redraw();
                 Logger::verbose("Item selected: " + label->get_text(), "revector");
             }
         }
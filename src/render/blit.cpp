@@ -76,6 +76,11 @@ Blit::Blit(const std::shared_ptr<Device> &_device, const std::shared_ptr<Queue>
 }
 
 void Blit::set_texture(const std::shared_ptr<Texture> &new_texture) {
+    // Pooled targets only change with their size class.
+    if (new_texture == texture) {
+        return;
+    }
+
     texture = new_texture;
 
     descriptor_set->add_or_update({
@@ -83,7 +88,13 @@ void Blit::set_texture(const std::shared_ptr<Texture> &new_texture) {
     });
 }
 
-void Blit::draw(const std::shared_ptr<CommandEncoder> &encoder) {
+void Blit::draw(const std::shared_ptr<CommandEncoder> &encoder, Vec2I target_size) {
+    // The viewport spans the whole texture, which maps it one texel per pixel. OpenGL viewports start at the bottom
+    // row, as do its textures, so the texture's top row is aligned with the target's there.
+    auto texture_size = texture->get_size();
+    int y = device->get_backend_type() == BackendType::Opengl ? target_size.y - texture_size.y : 0;
+    encoder->set_viewport({{0, y}, {texture_size.x, y + texture_size.y}});
+
     encoder->bind_render_pipeline(pipeline);
 
     encoder->bind_vertex_buffers({{vertex_buffer, 0}});
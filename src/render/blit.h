@@ -18,7 +18,10 @@ public:
 
     void set_texture(const std::shared_ptr<Pathfinder::Texture> &new_texture);
 
-    void draw(const std::shared_ptr<Pathfinder::CommandEncoder> &encoder);
+    /// Draw one texel per pixel from the top-left corner of a render pass target of `target_size`. Of a texture
+    /// larger than the target, e.g. a pooled render target, only the top-left part is drawn. Only the viewport
+    /// depends on the sizes, so resizing doesn't touch the vertex buffer.
+    void draw(const std::shared_ptr<Pathfinder::CommandEncoder> &encoder, Pathfinder::Vec2I target_size);
 
 private:
     std::shared_ptr<Pathfinder::Device> device;
@@ -0,0 +1,257 @@
+#include "render_level.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+// clang-format off
+#ifdef PATHFINDER_USE_VULKAN
+#include "pathfinder/gpu/vk/device.h"
+#endif
+// clang-format on
+
+#include "../common/geometry.h"
+#include "../common/utils.h"
+
+namespace vecgui {
+
+/// Bump when the calibration scene changes, so cached results are measured again.
+constexpr int RENDER_LEVEL_CALIBRATION_VERSION = 2;
+
+const Vec2I RENDER_LEVEL_CALIBRATION_SIZE = {1280, 720};
+
+/// Frames drawn before measuring, so pipelines and buffers are created.
+constexpr int RENDER_LEVEL_CALIBRATION_WARMUP_FRAMES = 2;
+
+constexpr int RENDER_LEVEL_CALIBRATION_FRAMES = 6;
+
+const char *get_render_level_name(Pathfinder::RenderLevel level) {
+    return level == Pathfinder::RenderLevel::D3d11 ? "D3D11" : "D3D9";
+}
+
+/// A busy screen of widgets: a grid of bordered, rounded boxes with small shapes standing in for their text.
+void record_calibration_scene(Pathfinder::Canvas &canvas) {
+    constexpr int columns = 32;
+    constexpr int rows = 24;
+
+    auto cell_size = Vec2F((float)RENDER_LEVEL_CALIBRATION_SIZE.x / columns,
+                           (float)RENDER_LEVEL_CALIBRATION_SIZE.y / rows);
+
+    canvas.set_transform(Transform2());
+
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++) {
+            auto position = Vec2F(column * cell_size.x, row * cell_size.y);
+
+            Pathfinder::Path2d box;
+            box.add_rect(RectF(position + Vec2F(2, 2), position + cell_size - Vec2F(2, 2)), 4);
+
+            canvas.set_fill_paint(Pathfinder::Paint::from_color(ColorU(60, 60, 60, 255)));
+            canvas.fill_path(box, Pathfinder::FillRule::Winding);
+
+            canvas.set_stroke_paint(Pathfinder::Paint::from_color(ColorU(120, 120, 120, 255)));
+            canvas.set_line_width(1);
+            canvas.stroke_path(box);
+
+            canvas.set_fill_paint(Pathfinder::Paint::from_color(ColorU(220, 220, 220, 255)));
+            for (int i = 0; i < 4; i++) {
+                Pathfinder::Path2d glyph;
+                glyph.add_circle(position + Vec2F(8 + i * 7, cell_size.y * 0.5f), 3);
+                canvas.fill_path(glyph, Pathfinder::FillRule::Winding);
+            }
+        }
+    }
+}
+
+double measure_render_level(Pathfinder::RenderLevel level,
+                            const std::shared_ptr<Pathfinder::Device> &device,
+                            const std::shared_ptr<Pathfinder::Queue> &queue) {
+    auto canvas = std::make_shared<Pathfinder::Canvas>(RENDER_LEVEL_CALIBRATION_SIZE, device, queue, level);
+
+    auto target = device->create_texture({RENDER_LEVEL_CALIBRATION_SIZE, Pathfinder::TextureFormat::Rgba8Unorm},
+                                         "render level calibration target");
+    canvas->set_dst_texture(target);
+
+    auto draw_frame = [&] {
+        // Recorded every frame, as the scene would change in an app, so tiling isn't skipped.
+        record_calibration_scene(*canvas);
+        canvas->draw(true);
+        canvas->take_scene();
+
+        // Wait for the GPU, so the time includes its work.
+        queue->submit_and_wait(device->create_command_encoder("render level calibration sync"));
+    };
+
+    for (int i = 0; i < RENDER_LEVEL_CALIBRATION_WARMUP_FRAMES; i++) {
+        draw_frame();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < RENDER_LEVEL_CALIBRATION_FRAMES; i++) {
+        draw_frame();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::milli>(elapsed).count() / RENDER_LEVEL_CALIBRATION_FRAMES;
+}
+
+std::string get_render_device_id(const std::shared_ptr<Pathfinder::Device> &device) {
+    std::ostringstream id;
+
+#ifdef PATHFINDER_USE_VULKAN
+    if (device->get_backend_type() == Pathfinder::BackendType::Vulkan) {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(static_cast<Pathfinder::DeviceVk *>(device.get())->get_physical_device(),
+                                      &properties);
+
+        id << std::hex << properties.vendorID << ":" << properties.deviceID << ":" << properties.driverVersion << ":"
+           << properties.deviceName;
+    }
+#endif
+
+    auto result = id.str();
+    if (result.empty()) {
+        return "unknown";
+    }
+
+    // Read back as one word, see read_cached_render_level().
+    for (auto &c : result) {
+        if (std::isspace((unsigned char)c)) {
+            c = '_';
+        }
+    }
+
+    return result;
+}
+
+std::string get_render_level_cache_path() {
+#if defined(_WIN32)
+    const char *cache_dir = getenv("LOCALAPPDATA");
+#elif defined(__ANDROID__)
+    const char *cache_dir = nullptr;
+#else
+    const char *cache_dir = getenv("XDG_CACHE_HOME");
+#endif
+
+    std::filesystem::path path;
+    if (cache_dir && *cache_dir) {
+        path = cache_dir;
+    } else {
+#if !defined(_WIN32) && !defined(__ANDROID__)
+        const char *home = getenv("HOME");
+        if (!home || !*home) {
+            return {};
+        }
+        path = std::filesystem::path(home) / ".cache";
+#else
+        return {};
+#endif
+    }
+
+    return (path / "revector" / "render_level").string();
+}
+
+/// The cached choice for this backend and device, if any.
+std::optional<Pathfinder::RenderLevel> read_cached_render_level(const std::string &path,
+                                                                 Pathfinder::BackendType backend,
+                                                                 const std::string &device_id) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    // Version, backend, device, chosen level, then the timings for reference.
+    int version = 0, cached_backend = 0, level = 0;
+    std::string cached_device_id;
+    if (!(file >> version >> cached_backend >> cached_device_id >> level) ||
+        version != RENDER_LEVEL_CALIBRATION_VERSION || cached_backend != (int)backend ||
+        cached_device_id != device_id) {
+        return std::nullopt;
+    }
+
+    return level == (int)Pathfinder::RenderLevel::D3d11 ? Pathfinder::RenderLevel::D3d11
+                                                         : Pathfinder::RenderLevel::D3d9;
+}
+
+void write_cached_render_level(const std::string &path,
+                               Pathfinder::BackendType backend,
+                               const std::string &device_id,
+                               Pathfinder::RenderLevel level,
+                               double d3d9_ms,
+                               double d3d11_ms) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream file(path);
+    if (error || !file) {
+        Logger::warn("Failed to cache the render level at " + path, "revector");
+        return;
+    }
+
+    file << RENDER_LEVEL_CALIBRATION_VERSION << " " << (int)backend << " " << device_id << " " << (int)level << " "
+         << d3d9_ms << " " << d3d11_ms << "\n";
+}
+
+Pathfinder::RenderLevel resolve_render_level(RenderLevel level,
+                                             const std::shared_ptr<Pathfinder::Device> &device,
+                                             const std::shared_ptr<Pathfinder::Queue> &queue) {
+    if (level == RenderLevel::D3d9) {
+        return Pathfinder::RenderLevel::D3d9;
+    }
+
+#ifndef PATHFINDER_USE_D3D11
+    if (level == RenderLevel::D3d11) {
+        Logger::warn("Pathfinder was built without the D3D11 render level, see VECGUI_D3D11. Using D3D9.",
+                     "revector");
+    }
+    return Pathfinder::RenderLevel::D3d9;
+#endif
+
+    auto backend = device->get_backend_type();
+
+    // The compute pipeline is only set up on Vulkan.
+    if (backend != Pathfinder::BackendType::Vulkan) {
+        if (level == RenderLevel::D3d11) {
+            Logger::warn("The D3D11 render level needs Vulkan, using D3D9.", "revector");
+        }
+        return Pathfinder::RenderLevel::D3d9;
+    }
+
+    if (level == RenderLevel::D3d11) {
+        return Pathfinder::RenderLevel::D3d11;
+    }
+
+    auto device_id = get_render_device_id(device);
+
+    auto cache_path = get_render_level_cache_path();
+    if (!cache_path.empty()) {
+        if (auto cached = read_cached_render_level(cache_path, backend, device_id)) {
+            Logger::info(std::string("Using the cached render level ") + get_render_level_name(*cached) + " from " +
+                             cache_path,
+                         "revector");
+            return *cached;
+        }
+    }
+
+    auto d3d9_ms = measure_render_level(Pathfinder::RenderLevel::D3d9, device, queue);
+    auto d3d11_ms = measure_render_level(Pathfinder::RenderLevel::D3d11, device, queue);
+
+    auto chosen = d3d11_ms < d3d9_ms ? Pathfinder::RenderLevel::D3d11 : Pathfinder::RenderLevel::D3d9;
+
+    std::ostringstream message;
+    message << "Render level calibration: D3D9 " << d3d9_ms << " ms, D3D11 " << d3d11_ms << " ms per frame, using "
+            << get_render_level_name(chosen) << ".";
+    Logger::info(message.str(), "revector");
+
+    if (!cache_path.empty()) {
+        write_cached_render_level(cache_path, backend, device_id, chosen, d3d9_ms, d3d11_ms);
+    }
+
+    return chosen;
+}
+
+} // namespace vecgui
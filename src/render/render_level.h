@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pathfinder/prelude.h>
+
+#include <memory>
+#include <string>
+
+namespace vecgui {
+
+/// Pathfinder render level to draw with, see App::App().
+enum class RenderLevel {
+    /// Tiles on the CPU and rasterizes on the GPU. Works everywhere.
+    D3d9,
+    /// Tiles and rasterizes in compute shaders, which scales better with many paths. Not available on OpenGL.
+    D3d11,
+    /// Whichever of the two is faster on the device, see resolve_render_level().
+    Auto,
+};
+
+const char *get_render_level_name(Pathfinder::RenderLevel level);
+
+/// Map a requested level to one the device can use. Auto renders a built-in calibration scene at both levels and
+/// picks the faster one. The choice is cached in get_render_level_cache_path() along with get_render_device_id(), so
+/// only the first start on a GPU and driver pays for it. Works on software Vulkan implementations too. Without
+/// VECGUI_D3D11, everything resolves to D3D9.
+Pathfinder::RenderLevel resolve_render_level(RenderLevel level,
+                                             const std::shared_ptr<Pathfinder::Device> &device,
+                                             const std::shared_ptr<Pathfinder::Queue> &queue);
+
+/// Time to record, tile and render the calibration scene at a level, in milliseconds per frame.
+double measure_render_level(Pathfinder::RenderLevel level,
+                            const std::shared_ptr<Pathfinder::Device> &device,
+                            const std::shared_ptr<Pathfinder::Queue> &queue);
+
+/// Vendor, device and driver version, and the device name, as one word. "unknown" where they can't be queried.
+std::string get_render_device_id(const std::shared_ptr<Pathfinder::Device> &device);
+
+/// In the user's cache directory. Empty if there is none, in which case Auto calibrates on every start.
+std::string get_render_level_cache_path();
+
+} // namespace vecgui
@@ -0,0 +1,96 @@
+#include "render_target_pool.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "../common/utils.h"
+#include "../servers/engine.h"
+#include "../servers/render_server.h"
+
+namespace vecgui {
+
+/// Size classes are multiples of this, in pixels.
+constexpr int32_t RENDER_TARGET_SIZE_STEP = 256;
+
+/// How long a target may stay larger than needed, and a released one may wait for reuse, in seconds.
+constexpr double RENDER_TARGET_SHRINK_DELAY = 1.0;
+
+Vec2I RenderTargetPool::get_size_class(Vec2I size) {
+    auto round_up = [](int32_t length) {
+        return std::max(1, (length + RENDER_TARGET_SIZE_STEP - 1) / RENDER_TARGET_SIZE_STEP) * RENDER_TARGET_SIZE_STEP;
+    };
+
+    return {round_up(size.x), round_up(size.y)};
+}
+
+std::shared_ptr<Pathfinder::Texture> RenderTargetPool::fit(const std::shared_ptr<Pathfinder::Texture> &current,
+                                                           Vec2I size) {
+    auto now = Engine::get_singleton()->get_elapsed();
+    auto size_class = get_size_class(size);
+
+    trim(now);
+
+    if (current) {
+        auto current_size = current->get_size();
+
+        if (current_size.x >= size.x && current_size.y >= size.y) {
+            if (current_size == size_class) {
+                oversized_since_.erase(current.get());
+                return current;
+            }
+
+            // Too large, but the size may grow back soon.
+            auto [it, _] = oversized_since_.try_emplace(current.get(), now);
+            if (now - it->second < RENDER_TARGET_SHRINK_DELAY) {
+                return current;
+            }
+        }
+
+        release(current);
+    }
+
+    auto it = std::ranges::find_if(free_targets_,
+                                   [&](const FreeTarget &target) { return target.texture->get_size() == size_class; });
+    if (it != free_targets_.end()) {
+        auto texture = it->texture;
+        free_targets_.erase(it);
+        return texture;
+    }
+
+    auto render_server = RenderServer::get_singleton();
+
+    std::ostringstream ss;
+    ss << "Allocating a render target of " << size_class;
+    Logger::verbose(ss.str(), "revector");
+
+    std::lock_guard gpu_lock(render_server->gpu_mutex_);
+    allocation_count_++;
+
+    return render_server->device_->create_texture({size_class, Pathfinder::TextureFormat::Rgba8Unorm},
+                                                  "pooled render target");
+}
+
+void RenderTargetPool::release(const std::shared_ptr<Pathfinder::Texture> &target) {
+    if (!target) {
+        return;
+    }
+
+    oversized_since_.erase(target.get());
+    free_targets_.push_back({target, Engine::get_singleton()->get_elapsed()});
+}
+
+uint32_t RenderTargetPool::get_allocation_count() const {
+    return allocation_count_;
+}
+
+void RenderTargetPool::clear() {
+    free_targets_.clear();
+    oversized_since_.clear();
+}
+
+void RenderTargetPool::trim(double now) {
+    std::erase_if(free_targets_,
+                  [now](const FreeTarget &target) { return now - target.release_time >= RENDER_TARGET_SHRINK_DELAY; });
+}
+
+} // namespace vecgui
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <pathfinder/prelude.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/geometry.h"
+
+namespace vecgui {
+
+/// Reuses Rgba8Unorm render targets across resizes. Targets are allocated in size classes, rounded up in steps,
+/// and only the top-left part of the requested size is used, so most size changes reuse the current target.
+/// Targets that are too large are only replaced once the smaller size has lasted a while, so a window being
+/// dragged back and forth doesn't allocate every frame.
+class RenderTargetPool {
+public:
+    static RenderTargetPool *get_singleton() {
+        static RenderTargetPool singleton;
+        return &singleton;
+    }
+
+    /// A target at least `size` large. Keeps `current` if it's still suitable, otherwise releases it.
+    std::shared_ptr<Pathfinder::Texture> fit(const std::shared_ptr<Pathfinder::Texture> &current, Vec2I size);
+
+    /// Give a target back, so it can be reused for a while.
+    void release(const std::shared_ptr<Pathfinder::Texture> &target);
+
+    /// Textures created since start up.
+    uint32_t get_allocation_count() const;
+
+    /// Free every pooled target, e.g. before the device is destroyed.
+    void clear();
+
+    static Vec2I get_size_class(Vec2I size);
+
+private:
+    /// Free the pooled targets that haven't been reused in time.
+    void trim(double now);
+
+    struct FreeTarget {
+        std::shared_ptr<Pathfinder::Texture> texture;
+        double release_time;
+    };
+
+    std::vector<FreeTarget> free_targets_;
+
+    /// Since when targets in use have been larger than needed.
+    std::unordered_map<const Pathfinder::Texture *, double> oversized_since_;
+
+    uint32_t allocation_count_ = 0;
+};
+
+} // namespace vecgui
@@ -2,6 +2,8 @@
 
 #include "font.h"
 #include "opensans_regular_ttf.h"
+#include "resource.h"
+#include "vector_image.h"
 
 namespace vecgui {
 
@@ -12,4 +14,14 @@ void DefaultResource::init(const bool dark_mode) {
     assert(default_font);
 }
 
+std::shared_ptr<VectorImage> DefaultResource::get_icon(const std::string &path, bool override_with_accent_color) {
+    auto &icon = icons[{path, override_with_accent_color}];
+
+    if (icon == nullptr) {
+        icon = std::make_shared<VectorImage>(get_asset_dir(path), override_with_accent_color);
+    }
+
+    return icon;
+}
+
 } // namespace vecgui
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <map>
+
 #include "theme.h"
 
 namespace vecgui {
 
 class Font;
+class VectorImage;
 
 class DefaultResource {
 public:
@@ -29,9 +32,15 @@ public:
         return default_font;
     }
 
+    /// Get a built-in SVG icon, e.g. "icons/ArrowRight.svg".
+    /// Icons are loaded once and shared by all widgets, instead of being parsed for every instance.
+    std::shared_ptr<VectorImage> get_icon(const std::string &path, bool override_with_accent_color = false);
+
 private:
     std::shared_ptr<Theme> default_theme;
     std::shared_ptr<Font> default_font;
+
+    std::map<std::pair<std::string, bool>, std::shared_ptr<VectorImage>> icons;
 };
 
 } // namespace vecgui
@@ -12,7 +12,10 @@ RenderImage::RenderImage(Vec2I _size) {
 
     type = ImageType::Render;
 
-    texture_ = RenderServer::get_singleton()->device_->create_texture(desc, "render image");
+    auto render_server = RenderServer::get_singleton();
+
+    std::lock_guard gpu_lock(render_server->gpu_mutex_);
+    texture_ = render_server->device_->create_texture(desc, "render image");
 }
 
 RenderImage::RenderImage(const std::shared_ptr<Pathfinder::Texture>& existing_texture) {
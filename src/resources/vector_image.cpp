@@ -28,7 +28,9 @@ VectorImage::VectorImage(const std::string &path, bool override_with_accent_colo
 
     svg_scene = VectorServer::get_singleton()->load_svg(path, override_with_accent_color);
 
-    size = svg_scene->get_size().to_i32();
+    if (svg_scene) {
+        size = svg_scene->get_size().to_i32();
+    }
 }
 
 void VectorImage::add_path(const VectorPath &new_path) {
@@ -1,5 +1,7 @@
 #include "engine.h"
 
+#include <algorithm>
+#include <bit>
 #include <sstream>
 
 #include "../common/utils.h"
@@ -9,31 +11,54 @@ namespace vecgui {
 /// Period to print the frame time, in seconds.
 constexpr float FRAME_TIME_PRINT_PERIOD = 5;
 
-float remove_elements_less_than(std::map<int64_t, float>& my_map, const int64_t target_key) {
-    float sum = 0;
-    size_t count = 0;
-
-    for (auto it = my_map.begin(); it != my_map.end();) {
-        if (it->first < target_key) {
-            // Erase the element and update the iterator to the next element
-            it = my_map.erase(it);
-        } else {
-            sum += it->second;
-            count++;
-            // Move to the next element
-            ++it;
-        }
+/// Number of recent frames the statistics are taken over.
+constexpr size_t FRAME_TIME_CAPACITY = 1024;
+
+/// Window to average the FPS over, in seconds.
+constexpr double FPS_AVERAGE_WINDOW = 1;
+
+// The histogram is log-linear, like HdrHistogram: below 32 us each microsecond has a bucket,
+// above that every power of two is split into 16 buckets, i.e. about 3% accuracy from the middle of a bucket.
+constexpr uint32_t FRAME_TIME_SUB_BUCKET_BITS = 4;
+constexpr uint32_t FRAME_TIME_SUB_BUCKET_COUNT = 1 << FRAME_TIME_SUB_BUCKET_BITS;
+constexpr uint32_t FRAME_TIME_LINEAR_LIMIT = FRAME_TIME_SUB_BUCKET_COUNT * 2;
+
+/// Frame times are clamped to about a minute.
+constexpr uint32_t FRAME_TIME_MAX_US = (1 << 26) - 1;
+constexpr uint32_t FRAME_TIME_BUCKET_COUNT = FRAME_TIME_LINEAR_LIMIT + (26 - 5) * FRAME_TIME_SUB_BUCKET_COUNT;
+
+uint32_t get_frame_time_bucket(float frame_time) {
+    auto us = (uint32_t)std::clamp(frame_time * 1e6f, 0.f, (float)FRAME_TIME_MAX_US);
+
+    if (us < FRAME_TIME_LINEAR_LIMIT) {
+        return us;
     }
 
-    if (count == 0) {
-        return sum;
+    uint32_t msb = std::bit_width(us) - 1;
+    uint32_t shift = msb - FRAME_TIME_SUB_BUCKET_BITS;
+    uint32_t sub_bucket = (us >> shift) - FRAME_TIME_SUB_BUCKET_COUNT;
+
+    return FRAME_TIME_LINEAR_LIMIT + (shift - 1) * FRAME_TIME_SUB_BUCKET_COUNT + sub_bucket;
+}
+
+/// The middle of a bucket, in seconds.
+double get_frame_time_bucket_value(uint32_t bucket) {
+    if (bucket < FRAME_TIME_LINEAR_LIMIT) {
+        return bucket * 1e-6;
     }
 
-    return sum / (float)count;
+    auto offset = bucket - FRAME_TIME_LINEAR_LIMIT;
+    uint32_t shift = offset / FRAME_TIME_SUB_BUCKET_COUNT + 1;
+    uint32_t lower = (FRAME_TIME_SUB_BUCKET_COUNT + offset % FRAME_TIME_SUB_BUCKET_COUNT) << shift;
+
+    return (lower + ((1u << shift) - 1) * 0.5) * 1e-6;
 }
 
 Engine::Engine() {
     last_time_updated_fps = std::chrono::steady_clock::now();
+
+    frame_times_.reserve(FRAME_TIME_CAPACITY);
+    histogram_.resize(FRAME_TIME_BUCKET_COUNT);
 }
 
 void Engine::tick() {
@@ -48,7 +73,8 @@ void Engine::tick() {
         return;
     }
 
-    dt = new_elapsed - elapsed;
+    dt = std::max(new_elapsed - elapsed - idle_time_, 0.0);
+    idle_time_ = 0;
 
     elapsed = new_elapsed;
 
@@ -59,38 +85,152 @@ void Engine::tick() {
     if (duration.count() > FRAME_TIME_PRINT_PERIOD) {
         // Show frame time.
         std::ostringstream string_stream;
-        string_stream << "Frame time: " << round(dt * 1000.f * 100.f) * 0.01f << " ms";
+        auto stats = get_frame_time_stats();
+        string_stream << "Frame time: " << round(dt * 1000.f * 100.f) * 0.01f << " ms, p50 "
+                      << round(stats.p50 * 1000.f * 100.f) * 0.01f << " ms, p99 "
+                      << round(stats.p99 * 1000.f * 100.f) * 0.01f << " ms, over budget " << stats.over_budget_count
+                      << "/" << stats.frame_count;
         Logger::info(string_stream.str(), "revector");
         last_time_updated_fps = current_time;
     }
     // ----------------------------------------
 
-    int64_t nanoseconds = current_time.time_since_epoch().count();
-    frametimes[nanoseconds] = dt;
+    push_frame_time(dt);
 }
 
 double Engine::get_dt() const {
     return dt;
 }
 
+void Engine::begin_idle_wait() {
+    idle_wait_start_ = std::chrono::steady_clock::now();
+}
+
+double Engine::end_idle_wait() {
+    auto waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - idle_wait_start_).count();
+    idle_time_ += waited;
+
+    return waited;
+}
+
 double Engine::get_elapsed() const {
     return elapsed;
 }
 
 float Engine::get_fps() {
-    auto current_time = std::chrono::steady_clock::now();
-    int64_t nanoseconds = current_time.time_since_epoch().count();
-
-    float average = remove_elements_less_than(frametimes, nanoseconds - fps_average_window);
-    if (average == 0) {
+    if (fps_time_sum_ <= 0) {
         return 0;
     }
 
-    return 1.0f / average;
+    return (float)(fps_frame_count_ / fps_time_sum_);
 }
 
 int Engine::get_fps_int() {
     return int(round(get_fps()));
 }
 
+FrameTimeStats Engine::get_frame_time_stats() const {
+    FrameTimeStats stats;
+    stats.frame_count = frame_times_.size();
+    stats.over_budget_count = over_budget_count_;
+
+    if (frame_times_.empty()) {
+        return stats;
+    }
+
+    stats.max = max_candidates_.front();
+
+    // Ranks of the percentiles, in increasing order.
+    std::array<double *, 3> results = {&stats.p50, &stats.p90, &stats.p99};
+    std::array<uint32_t, 3> ranks = {
+        (uint32_t)(stats.frame_count * 0.5),
+        (uint32_t)(stats.frame_count * 0.9),
+        (uint32_t)(stats.frame_count * 0.99),
+    };
+
+    // A fixed number of buckets, so this is O(1) regardless of the frame count.
+    uint32_t cumulative = 0;
+    size_t next = 0;
+    for (uint32_t bucket = 0; bucket < FRAME_TIME_BUCKET_COUNT && next < ranks.size(); bucket++) {
+        cumulative += histogram_[bucket];
+        while (next < ranks.size() && cumulative > ranks[next]) {
+            *results[next] = std::min(get_frame_time_bucket_value(bucket), stats.max);
+            next++;
+        }
+    }
+
+    return stats;
+}
+
+void Engine::set_frame_budget(double budget) {
+    frame_budget_ = budget;
+
+    over_budget_count_ = std::ranges::count_if(frame_times_, [&](float t) { return t > frame_budget_; });
+}
+
+double Engine::get_frame_budget() const {
+    return frame_budget_;
+}
+
+void Engine::set_jank_threshold(double threshold) {
+    jank_threshold_ = threshold;
+}
+
+void Engine::push_frame_time(double frame_time) {
+    auto t = (float)frame_time;
+
+    // Evict the oldest frame.
+    if (frame_times_.size() == FRAME_TIME_CAPACITY) {
+        auto oldest = frame_times_[next_frame_];
+
+        histogram_[get_frame_time_bucket(oldest)]--;
+
+        if (oldest > frame_budget_) {
+            over_budget_count_--;
+        }
+
+        if (max_candidates_.front() == oldest) {
+            max_candidates_.pop_front();
+        }
+
+        if (fps_frame_count_ == FRAME_TIME_CAPACITY) {
+            fps_time_sum_ -= oldest;
+            fps_frame_count_--;
+        }
+
+        frame_times_[next_frame_] = t;
+    } else {
+        frame_times_.push_back(t);
+    }
+    next_frame_ = (next_frame_ + 1) % FRAME_TIME_CAPACITY;
+
+    histogram_[get_frame_time_bucket(t)]++;
+
+    if (t > frame_budget_) {
+        over_budget_count_++;
+    }
+
+    while (!max_candidates_.empty() && max_candidates_.back() < t) {
+        max_candidates_.pop_back();
+    }
+    max_candidates_.push_back(t);
+
+    // Keep the FPS window to the last second.
+    fps_time_sum_ += t;
+    fps_frame_count_++;
+    while (fps_frame_count_ > 1) {
+        auto oldest_index = (next_frame_ + FRAME_TIME_CAPACITY - fps_frame_count_) % FRAME_TIME_CAPACITY;
+        auto oldest = frame_times_[oldest_index];
+        if (fps_time_sum_ - oldest < FPS_AVERAGE_WINDOW) {
+            break;
+        }
+        fps_time_sum_ -= oldest;
+        fps_frame_count_--;
+    }
+
+    if (frame_time > jank_threshold_) {
+        signal_jank.emit(frame_time);
+    }
+}
+
 } // namespace vecgui
@@ -1,10 +1,28 @@
 #pragma once
 
+#include <array>
 #include <chrono>
-#include <map>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "../common/signal.h"
 
 namespace vecgui {
 
+/// Over the most recent frames, see Engine::get_frame_time_stats(). Times are in seconds.
+struct FrameTimeStats {
+    uint32_t frame_count = 0;
+
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+
+    /// Frames that took longer than the frame budget.
+    uint32_t over_budget_count = 0;
+};
+
 class Engine {
 public:
     static Engine *get_singleton() {
@@ -17,21 +35,66 @@ public:
 
     void tick();
 
+    /// Frame time in seconds. Idle waits are left out.
     double get_dt() const;
 
+    /// Bracket waits for events while idle, so the next frame time excludes them.
+    void begin_idle_wait();
+
+    /// Returns the time waited, in seconds.
+    double end_idle_wait();
+
     double get_elapsed() const;
 
+    /// Average over the last second.
     float get_fps();
 
     int get_fps_int();
 
+    /// Percentiles are accurate to about 3%.
+    FrameTimeStats get_frame_time_stats() const;
+
+    /// In seconds. 60 FPS by default.
+    void set_frame_budget(double budget);
+
+    double get_frame_budget() const;
+
+    /// Frames longer than this, in seconds, emit signal_jank. Twice the default frame budget by default.
+    void set_jank_threshold(double threshold);
+
+    /// Emitted with the frame time when a frame exceeds the jank threshold.
+    Signal<double> signal_jank;
+
     void *asset_manager{};
 
 private:
+    void push_frame_time(double frame_time);
+
     std::chrono::time_point<std::chrono::steady_clock> last_time_updated_fps;
 
-    std::map<int64_t, float> frametimes;
-    int64_t fps_average_window = 1000000000; // ns
+    /// Ring buffer of the most recent frame times, in seconds.
+    std::vector<float> frame_times_;
+    size_t next_frame_ = 0;
+
+    /// Histogram of the frame times in the ring buffer, see get_frame_time_bucket().
+    std::vector<uint32_t> histogram_;
+
+    /// Frame times in the ring buffer in decreasing order, so the front is the maximum.
+    std::deque<float> max_candidates_;
+
+    uint32_t over_budget_count_ = 0;
+
+    double frame_budget_ = 1.0 / 60.0;
+    double jank_threshold_ = 2.0 / 60.0;
+
+    /// Frames within the FPS averaging window, by the ring buffer: the newest `fps_frame_count_` frames.
+    size_t fps_frame_count_ = 0;
+    double fps_time_sum_ = 0;
+
+    std::chrono::time_point<std::chrono::steady_clock> idle_wait_start_;
+
+    /// Waited since the last tick, left out of its frame time.
+    double idle_time_ = 0;
 
     double elapsed = 0;
     double dt = 0;
@@ -2,14 +2,25 @@
 
 #include <pathfinder/prelude.h>
 
+#include <algorithm>
 #include <codecvt>
 #include <locale>
+#include <sstream>
 
 #include "../nodes/proxy_window.h"
 #include "render_server.h"
 
 namespace vecgui {
 
+/// Number of recent input events latency percentiles are taken over.
+constexpr size_t INPUT_LATENCY_SAMPLE_COUNT = 1024;
+
+/// Most events a frame tracks for latency, e.g. in a mouse storm. Older ones are dropped.
+constexpr size_t INPUT_LATENCY_MAX_PENDING_EVENTS = 1024;
+
+/// Period to print input latency, in seconds.
+constexpr float INPUT_LATENCY_PRINT_PERIOD = 5;
+
 std::string cpp11_codepoint_to_utf8(char32_t codepoint) {
     char utf8[4];
     char *end_of_utf8;
@@ -43,6 +54,12 @@ InputServer::InputServer() {
 void InputServer::initialize_window_callbacks(uint8_t window_index) {
 #ifndef __ANDROID__
     auto render_server = RenderServer::get_singleton();
+
+    // Headless windows only get synthetic input.
+    if (render_server->is_headless()) {
+        return;
+    }
+
     auto window = (GLFWwindow *)render_server->window_builder_->get_window(window_index).lock()->get_glfw_handle();
 
     // A lambda function that doesn't capture anything can be implicitly converted to a regular function pointer.
@@ -60,43 +77,21 @@ void InputServer::initialize_window_callbacks(uint8_t window_index) {
         y_pos /= dpi_scale_x;
     #endif
 
-        InputEvent input_event{};
-        input_event.type = InputEventType::MouseMotion;
-        input_event.window_index = pf_window->window_index;
-        input_event.args.mouse_motion.position = {(float)x_pos, (float)y_pos};
-        auto input_server = get_singleton();
-        input_server->last_cursor_position = input_server->cursor_position;
-        input_server->cursor_position = {(float)x_pos, (float)y_pos};
-        input_event.args.mouse_motion.relative = input_server->cursor_position - input_server->last_cursor_position;
-        input_server->input_queue.push_back(input_event);
+        get_singleton()->push_mouse_motion(pf_window->window_index, {(float)x_pos, (float)y_pos});
     };
     glfwSetCursorPosCallback(window, cursor_position_callback);
 
     auto cursor_button_callback = [](GLFWwindow *window, int button, int action, int mods) {
         auto pf_window = reinterpret_cast<Pathfinder::Window *>(glfwGetWindowUserPointer(window));
 
-        InputEvent input_event{};
-        input_event.type = InputEventType::MouseButton;
-        input_event.window_index = pf_window->window_index;
-        input_event.args.mouse_button.button = button;
-        input_event.args.mouse_button.pressed = action == GLFW_PRESS;
-        auto input_server = get_singleton();
-        input_event.args.mouse_button.position = input_server->cursor_position;
-        input_server->input_queue.push_back(input_event);
+        get_singleton()->push_mouse_button(pf_window->window_index, button, action == GLFW_PRESS);
     };
     glfwSetMouseButtonCallback(window, cursor_button_callback);
 
     auto cursor_scroll_callback = [](GLFWwindow *window, double x_offset, double y_offset) {
         auto pf_window = reinterpret_cast<Pathfinder::Window *>(glfwGetWindowUserPointer(window));
 
-        InputEvent input_event{};
-        input_event.type = InputEventType::MouseScroll;
-        input_event.window_index = pf_window->window_index;
-        input_event.args.mouse_scroll.x_delta = x_offset;
-        input_event.args.mouse_scroll.y_delta = y_offset;
-
-        auto input_server = get_singleton();
-        input_server->input_queue.push_back(input_event);
+        get_singleton()->push_mouse_scroll(pf_window->window_index, {(float)x_offset, (float)y_offset});
     };
     glfwSetScrollCallback(window, cursor_scroll_callback);
 
@@ -164,40 +159,163 @@ void InputServer::initialize_window_callbacks(uint8_t window_index) {
             }
         }
 
-        if (key_args.pressed) {
-            input_server->keys_pressed.insert(key_args.key);
-        } else if (key_args.repeated) {
-        } else {
-            input_server->keys_pressed.erase(key_args.key);
-        }
-
-        input_server->input_queue.push_back(input_event);
+        input_server->push_key(input_event.window_index, key_args.key, key_args.pressed, key_args.repeated);
     };
     glfwSetKeyCallback(window, key_callback);
 
     auto character_callback = [](GLFWwindow *window, unsigned int codepoint) {
         auto pf_window = reinterpret_cast<Pathfinder::Window *>(glfwGetWindowUserPointer(window));
 
-        InputEvent input_event{};
-        input_event.type = InputEventType::Text;
-        input_event.window_index = pf_window->window_index;
-        input_event.args.text.codepoint = codepoint;
-        auto input_server = get_singleton();
-        input_server->input_queue.push_back(input_event);
+        get_singleton()->push_text(pf_window->window_index, codepoint);
     };
 
     glfwSetCharCallback(window, character_callback);
 #endif
 }
 
+void InputServer::push_event(InputEvent event) {
+    event.timestamp = std::chrono::steady_clock::now();
+    input_queue.push_back(event);
+}
+
+void InputServer::push_mouse_motion(uint8_t window_index, Vec2F position) {
+    InputEvent input_event{};
+    input_event.type = InputEventType::MouseMotion;
+    input_event.window_index = window_index;
+    input_event.args.mouse_motion.position = position;
+
+    last_cursor_position = cursor_position;
+    cursor_position = position;
+    input_event.args.mouse_motion.relative = cursor_position - last_cursor_position;
+
+    push_event(input_event);
+}
+
+void InputServer::push_mouse_button(uint8_t window_index, uint8_t button, bool pressed) {
+    InputEvent input_event{};
+    input_event.type = InputEventType::MouseButton;
+    input_event.window_index = window_index;
+    input_event.args.mouse_button.button = button;
+    input_event.args.mouse_button.pressed = pressed;
+    input_event.args.mouse_button.position = cursor_position;
+
+    push_event(input_event);
+}
+
+void InputServer::push_mouse_scroll(uint8_t window_index, Vec2F delta) {
+    InputEvent input_event{};
+    input_event.type = InputEventType::MouseScroll;
+    input_event.window_index = window_index;
+    input_event.args.mouse_scroll.x_delta = delta.x;
+    input_event.args.mouse_scroll.y_delta = delta.y;
+
+    push_event(input_event);
+}
+
+void InputServer::push_key(uint8_t window_index, KeyCode key, bool pressed, bool repeated) {
+    InputEvent input_event{};
+    input_event.type = InputEventType::Key;
+    input_event.window_index = window_index;
+    input_event.args.key.key = key;
+    input_event.args.key.pressed = pressed;
+    input_event.args.key.repeated = repeated;
+
+    if (pressed) {
+        keys_pressed.insert(key);
+    } else if (!repeated) {
+        keys_pressed.erase(key);
+    }
+
+    push_event(input_event);
+}
+
+void InputServer::push_text(uint8_t window_index, uint32_t codepoint) {
+    InputEvent input_event{};
+    input_event.type = InputEventType::Text;
+    input_event.window_index = window_index;
+    input_event.args.text.codepoint = codepoint;
+
+    push_event(input_event);
+}
+
 void InputServer::clear_events() {
     input_queue.clear();
 }
 
+void InputServer::coalesce_events() {
+    motion_history.clear();
+
+    if (motion_history_users > 0) {
+        for (auto &event : input_queue) {
+            if (event.type == InputEventType::MouseMotion) {
+                motion_history.push_back(event);
+            }
+        }
+    }
+
+    // Index of the first event in the current run of coalescible events.
+    size_t run_start = 0;
+
+    size_t count = 0;
+
+    for (auto &event : input_queue) {
+        bool coalescible = event.type == InputEventType::MouseMotion || event.type == InputEventType::MouseScroll;
+
+        if (!coalescible) {
+            input_queue[count++] = event;
+            run_start = count;
+            continue;
+        }
+
+        // Merge into the earlier event of the same kind in this run, if any.
+        bool merged = false;
+        for (size_t i = run_start; i < count; i++) {
+            auto &previous = input_queue[i];
+            if (previous.type != event.type || previous.window_index != event.window_index) {
+                continue;
+            }
+
+            if (event.type == InputEventType::MouseMotion) {
+                previous.args.mouse_motion.relative =
+                    previous.args.mouse_motion.relative + event.args.mouse_motion.relative;
+                previous.args.mouse_motion.position = event.args.mouse_motion.position;
+            } else {
+                previous.args.mouse_scroll.x_delta += event.args.mouse_scroll.x_delta;
+                previous.args.mouse_scroll.y_delta += event.args.mouse_scroll.y_delta;
+            }
+
+            merged = true;
+            break;
+        }
+
+        if (!merged) {
+            input_queue[count++] = event;
+        }
+    }
+
+    input_queue.resize(count);
+}
+
+void InputServer::enable_motion_history(bool enabled) {
+    if (enabled) {
+        motion_history_users++;
+    } else if (motion_history_users > 0) {
+        motion_history_users--;
+    }
+}
+
+const std::vector<InputEvent> &InputServer::get_motion_history() const {
+    return motion_history;
+}
+
 std::string InputServer::get_clipboard() {
 #ifndef __ANDROID__
+    if (RenderServer::get_singleton()->is_headless()) {
+        return headless_clipboard;
+    }
+
     auto chars = glfwGetClipboardString(nullptr);
-    return std::string(chars);
+    return chars ? std::string(chars) : std::string();
 #else
     return "";
 #endif
@@ -205,6 +323,11 @@ std::string InputServer::get_clipboard() {
 
 void InputServer::set_clipboard(const std::string &text) {
 #ifndef __ANDROID__
+    if (RenderServer::get_singleton()->is_headless()) {
+        headless_clipboard = text;
+        return;
+    }
+
     glfwSetClipboardString(nullptr, text.c_str());
 #endif
 }
@@ -212,6 +335,9 @@ void InputServer::set_clipboard(const std::string &text) {
 void InputServer::set_cursor(uint8_t window_index, CursorShape shape) {
 #ifndef __ANDROID__
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
     auto window = (GLFWwindow *)render_server->window_builder_->get_window(window_index).lock()->get_glfw_handle();
 
     GLFWcursor *current_cursor{};
@@ -254,6 +380,9 @@ bool InputServer::is_key_pressed(KeyCode code) const {
 void InputServer::set_cursor_captured(uint8_t window_index, bool captured) {
 #ifndef __ANDROID__
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
     auto window = (GLFWwindow *)render_server->window_builder_->get_window(window_index).lock()->get_glfw_handle();
 
     glfwSetInputMode(window, GLFW_CURSOR, captured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
@@ -263,6 +392,9 @@ void InputServer::set_cursor_captured(uint8_t window_index, bool captured) {
 void InputServer::hide_cursor(uint8_t window_index) {
 #ifndef __ANDROID__
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
     auto window = (GLFWwindow *)render_server->window_builder_->get_window(window_index).lock()->get_glfw_handle();
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
@@ -272,10 +404,120 @@ void InputServer::hide_cursor(uint8_t window_index) {
 void InputServer::restore_cursor(uint8_t window_index) {
 #ifndef __ANDROID__
     auto render_server = RenderServer::get_singleton();
+    if (render_server->is_headless()) {
+        return;
+    }
     auto window = (GLFWwindow *)render_server->window_builder_->get_window(window_index).lock()->get_glfw_handle();
 
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 #endif
 }
 
+void InputServer::mark_latency_stage(LatencyStage stage) {
+    auto now = std::chrono::steady_clock::now();
+
+    if (stage == LatencyStage::Dispatched) {
+        for (auto &event : input_queue) {
+            latency_pending_events.push_back(event.timestamp);
+        }
+
+        if (latency_pending_events.size() > INPUT_LATENCY_MAX_PENDING_EVENTS) {
+            latency_pending_events.erase(latency_pending_events.begin(),
+                                         latency_pending_events.end() - INPUT_LATENCY_MAX_PENDING_EVENTS);
+        }
+    }
+
+    latency_stage_times[(size_t)stage] = now;
+}
+
+void InputServer::finish_latency_frame() {
+    add_latency_samples(latency_pending_events, latency_stage_times);
+    latency_pending_events.clear();
+}
+
+LatencyFrame InputServer::take_latency_frame() {
+    LatencyFrame frame{std::move(latency_pending_events), latency_stage_times};
+    latency_pending_events.clear();
+    return frame;
+}
+
+void InputServer::finish_latency_frame(const LatencyFrame &frame) {
+    add_latency_samples(frame.events, frame.stage_times);
+}
+
+void InputServer::add_latency_samples(
+    const std::vector<std::chrono::steady_clock::time_point> &events,
+    const std::array<std::chrono::steady_clock::time_point, (size_t)LatencyStage::Max> &stage_times) {
+    auto presented = stage_times[(size_t)LatencyStage::Presented];
+    if (events.empty() || presented < stage_times[(size_t)LatencyStage::Dispatched]) {
+        return;
+    }
+
+    for (auto arrival : events) {
+        LatencySample sample{};
+        sample.total = std::chrono::duration<double>(presented - arrival).count();
+
+        auto previous = arrival;
+        for (size_t i = 0; i < (size_t)LatencyStage::Max; i++) {
+            // Stages skipped this frame, e.g. when nothing was drawn, count as zero.
+            auto time = std::max(stage_times[i], previous);
+            sample.stages[i] = std::chrono::duration<float>(time - previous).count();
+            previous = time;
+        }
+
+        if (latency_samples.size() < INPUT_LATENCY_SAMPLE_COUNT) {
+            latency_samples.push_back(sample);
+        } else {
+            latency_samples[latency_sample_cursor] = sample;
+            latency_sample_cursor = (latency_sample_cursor + 1) % INPUT_LATENCY_SAMPLE_COUNT;
+        }
+    }
+
+    // Print input latency.
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last_time_printed_latency).count() > INPUT_LATENCY_PRINT_PERIOD) {
+        auto stats = get_input_latency();
+
+        std::ostringstream string_stream;
+        string_stream << "Input latency: p50 " << round(stats.p50 * 1000.f * 100.f) * 0.01f << " ms, p95 "
+                      << round(stats.p95 * 1000.f * 100.f) * 0.01f << " ms, p99 "
+                      << round(stats.p99 * 1000.f * 100.f) * 0.01f << " ms";
+        Logger::info(string_stream.str(), "revector");
+        last_time_printed_latency = now;
+    }
+}
+
+InputLatencyStats InputServer::get_input_latency() const {
+    InputLatencyStats stats;
+    stats.sample_count = latency_samples.size();
+
+    if (latency_samples.empty()) {
+        return stats;
+    }
+
+    std::vector<double> totals;
+    totals.reserve(latency_samples.size());
+
+    for (auto &sample : latency_samples) {
+        totals.push_back(sample.total);
+        for (size_t i = 0; i < (size_t)LatencyStage::Max; i++) {
+            stats.stage_means[i] += sample.stages[i];
+        }
+    }
+
+    for (auto &mean : stats.stage_means) {
+        mean /= (double)latency_samples.size();
+    }
+
+    std::ranges::sort(totals);
+
+    auto percentile = [&](double p) { return totals[std::min(totals.size() - 1, (size_t)(p * totals.size()))]; };
+
+    stats.p50 = percentile(0.5);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+
+    return stats;
+}
+
 } // namespace vecgui
@@ -2,6 +2,8 @@
 
 #include <pathfinder/prelude.h>
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <vector>
 
@@ -72,6 +74,40 @@ public:
     } args{};
 
     bool consumed = false;
+
+    /// When the event arrived. Coalesced events keep the earliest one.
+    std::chrono::steady_clock::time_point timestamp;
+};
+
+/// Points in a frame that input events pass through, see InputServer::mark_latency_stage().
+enum class LatencyStage {
+    Dispatched, // Delivered to nodes.
+    Updated,    // Update, layout and transform done.
+    Drawn,      // Nodes drawn.
+    Submitted,  // Vector scene submitted to the GPU.
+    Presented,  // Swap chain presented.
+    Max,
+};
+
+/// Input events of a frame presented elsewhere, e.g. on the render thread, see InputServer::take_latency_frame().
+struct LatencyFrame {
+    /// Arrival times.
+    std::vector<std::chrono::steady_clock::time_point> events;
+
+    std::array<std::chrono::steady_clock::time_point, (size_t)LatencyStage::Max> stage_times{};
+};
+
+/// Input-to-present latency over the most recent input events.
+struct InputLatencyStats {
+    size_t sample_count = 0;
+
+    // In seconds.
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+
+    /// Mean time from the previous stage (or arrival) to each stage, in seconds.
+    std::array<double, (size_t)LatencyStage::Max> stage_means{};
 };
 
 /// Unicode codepoint to UTF8 string.
@@ -111,8 +147,31 @@ public:
 
     void initialize_window_callbacks(uint8_t window_index);
 
+    /// Timestamp an event and queue it.
+    void push_event(InputEvent event);
+
+    // Queue input like native windows do, updating the cursor position and pressed keys.
+    // Also for synthetic input, e.g. in headless mode.
+    void push_mouse_motion(uint8_t window_index, Vec2F position);
+    void push_mouse_button(uint8_t window_index, uint8_t button, bool pressed);
+    void push_mouse_scroll(uint8_t window_index, Vec2F delta);
+    void push_key(uint8_t window_index, KeyCode key, bool pressed, bool repeated = false);
+    void push_text(uint8_t window_index, uint32_t codepoint);
+
     void clear_events();
 
+    /// Merge runs of mouse motion and scroll events of the same window into one event each, keeping the latest
+    /// position and summing relative movements and scroll deltas. Runs end at any other event, so the order
+    /// relative to button and key events is kept. High-polling-rate mice can send dozens of motions per frame.
+    void coalesce_events();
+
+    /// Keep the raw motion events of each frame before coalescing, see get_motion_history().
+    /// Reference counted, so every widget enabling it (e.g. a drawing canvas) must disable it again.
+    void enable_motion_history(bool enabled);
+
+    /// All mouse motion events of the current frame in order, if enabled.
+    const std::vector<InputEvent> &get_motion_history() const;
+
     std::string get_clipboard();
     void set_clipboard(const std::string &text);
 
@@ -131,6 +190,24 @@ public:
 
     bool is_key_pressed(KeyCode code) const;
 
+    /// Record that the input events of this frame reached a stage. Dispatched also takes the events from the queue,
+    /// so mark it after dispatching and before clearing the queue. With several windows, the last mark wins.
+    void mark_latency_stage(LatencyStage stage);
+
+    /// Turn the events of a presented frame into latency samples, and close out the frame. Events of a frame that
+    /// wasn't presented, e.g. headless, minimized or skipped as idle, had no visible effect and are dropped, rather
+    /// than timed against a later, unrelated present.
+    void finish_latency_frame();
+
+    /// Take the pending events and the stage times so far, for a frame that will be presented elsewhere.
+    /// Whoever presents it fills in the remaining stages and passes it back to finish_latency_frame().
+    LatencyFrame take_latency_frame();
+
+    /// Like finish_latency_frame(), for a taken frame.
+    void finish_latency_frame(const LatencyFrame &frame);
+
+    InputLatencyStats get_input_latency() const;
+
 private:
 #ifndef ANDROID
     GLFWcursor *arrow_cursor, *ibeam_cursor, *crosshair_cursor, *hand_cursor, *resize_cursor_h, *resize_cursor_v;
@@ -141,6 +218,34 @@ private:
     CursorShape current_cursor_shape = CursorShape::Arrow;
 
     std::set<KeyCode> keys_pressed;
+
+    /// Headless windows have no system clipboard.
+    std::string headless_clipboard;
+
+    uint32_t motion_history_users = 0;
+
+    std::vector<InputEvent> motion_history;
+
+    struct LatencySample {
+        double total;
+        std::array<float, (size_t)LatencyStage::Max> stages;
+    };
+
+    /// Adds nothing if the frame wasn't presented after its events were dispatched.
+    void add_latency_samples(
+        const std::vector<std::chrono::steady_clock::time_point> &events,
+        const std::array<std::chrono::steady_clock::time_point, (size_t)LatencyStage::Max> &stage_times);
+
+    /// Arrival times of the events dispatched but not presented yet.
+    std::vector<std::chrono::steady_clock::time_point> latency_pending_events;
+
+    std::array<std::chrono::steady_clock::time_point, (size_t)LatencyStage::Max> latency_stage_times{};
+
+    /// Ring buffer of the most recent samples.
+    std::vector<LatencySample> latency_samples;
+    size_t latency_sample_cursor = 0;
+
+    std::chrono::steady_clock::time_point last_time_printed_latency;
 };
 
 } // namespace vecgui
@@ -0,0 +1,156 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace vecgui {
+
+/// About a minute of frames with a dozen zones each.
+constexpr size_t PROFILER_RECORD_CAPACITY = 1 << 16;
+
+const char *PROFILE_COUNTER_NAMES[] = {"Draw calls", "Relayouts", "Reshapes", "Culled nodes", "Blit bytes", "Canvas paths"};
+
+const char *get_profile_counter_name(ProfileCounter counter) {
+    return PROFILE_COUNTER_NAMES[(size_t)counter];
+}
+
+uint32_t get_thread_index() {
+    static std::atomic<uint32_t> thread_count = 0;
+    thread_local uint32_t thread_index = thread_count++;
+    return thread_index;
+}
+
+Profiler::Profiler() {
+    start_time_ = std::chrono::steady_clock::now();
+    frame_start_time_ = start_time_;
+    records_.reserve(PROFILER_RECORD_CAPACITY);
+}
+
+void Profiler::record_zone(const char *name,
+                           std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) {
+    auto start_ns = to_profiler_time(start);
+    push({name, start_ns, to_profiler_time(end) - start_ns, get_thread_index(), false, NodeType::Node, 0});
+}
+
+void Profiler::end_frame() {
+    auto now = std::chrono::steady_clock::now();
+    record_zone("Frame", frame_start_time_, now);
+    frame_start_time_ = now;
+
+    auto time = to_profiler_time(now);
+
+    for (size_t type = 0; type < (size_t)NodeType::Max; type++) {
+        for (size_t counter = 0; counter < (size_t)ProfileCounter::Max; counter++) {
+            auto value = counters_[type][counter].exchange(0, std::memory_order_relaxed);
+            frame_counters_[type][counter] = value;
+
+            if (value > 0) {
+                push({PROFILE_COUNTER_NAMES[counter], time, 0, get_thread_index(), true, (NodeType)type, value});
+            }
+        }
+    }
+}
+
+uint32_t Profiler::get_frame_count(NodeType type, ProfileCounter counter) const {
+    return frame_counters_[(size_t)type][(size_t)counter];
+}
+
+std::vector<ProfileZoneTotal> Profiler::get_zone_totals() const {
+    std::lock_guard lock(mutex_);
+
+    // The same name may be spelled by several string literals.
+    std::vector<ProfileZoneTotal> totals;
+    for (auto &[_, zone] : zone_totals_) {
+        auto it = std::ranges::find(totals, zone.name, &ProfileZoneTotal::name);
+        if (it == totals.end()) {
+            totals.push_back(zone);
+        } else {
+            it->duration += zone.duration;
+            it->count += zone.count;
+        }
+    }
+
+    return totals;
+}
+
+std::string Profiler::to_chrome_trace_json() const {
+    std::lock_guard lock(mutex_);
+
+    std::ostringstream json;
+    json << "{\"traceEvents\":[";
+
+    // Oldest first.
+    bool first = true;
+    for (size_t i = 0; i < records_.size(); i++) {
+        auto &record = records_[(next_record_ + i) % records_.size()];
+
+        if (!first) {
+            json << ",";
+        }
+        first = false;
+
+        // Timestamps are in microseconds.
+        json << "\n{\"pid\":0,\"tid\":" << record.thread_index << ",\"ts\":" << record.start / 1000.0;
+
+        if (record.is_counter) {
+            json << ",\"ph\":\"C\",\"name\":\"" << record.name << "\",\"args\":{\""
+                 << get_node_type_name(record.node_type) << "\":" << record.value << "}}";
+        } else {
+            json << ",\"ph\":\"X\",\"name\":\"" << record.name << "\",\"dur\":" << record.duration / 1000.0 << "}";
+        }
+    }
+
+    json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return json.str();
+}
+
+bool Profiler::export_chrome_trace(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file) {
+        Logger::error("Failed to open " + path + " for the profiler trace!", "revector");
+        return false;
+    }
+
+    file << to_chrome_trace_json();
+
+    Logger::info("Profiler trace written to " + path, "revector");
+
+    return true;
+}
+
+void Profiler::clear() {
+    std::lock_guard lock(mutex_);
+
+    records_.clear();
+    next_record_ = 0;
+    zone_totals_.clear();
+}
+
+void Profiler::push(const Record &record) {
+    std::lock_guard lock(mutex_);
+
+    if (!record.is_counter) {
+        auto &total = zone_totals_[record.name];
+        if (total.count == 0) {
+            total.name = record.name;
+        }
+        total.duration += record.duration;
+        total.count++;
+    }
+
+    if (records_.size() < PROFILER_RECORD_CAPACITY) {
+        records_.push_back(record);
+    } else {
+        records_[next_record_] = record;
+        next_record_ = (next_record_ + 1) % PROFILER_RECORD_CAPACITY;
+    }
+}
+
+int64_t Profiler::to_profiler_time(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - start_time_).count();
+}
+
+} // namespace vecgui
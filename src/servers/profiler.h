@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../nodes/node.h"
+
+namespace vecgui {
+
+/// Accumulated over the records of a zone, see Profiler::get_zone_totals().
+struct ProfileZoneTotal {
+    std::string name;
+    /// In nanoseconds.
+    int64_t duration = 0;
+    uint32_t count = 0;
+};
+
+enum class ProfileCounter {
+    DrawCalls,
+    Relayouts,
+    Reshapes,
+    /// Nodes skipped by the draw pass, along with their subtrees.
+    Culled,
+    /// Memory traffic of the windows' blit passes. Only the blit's reads and writes, not the canvas writing its target.
+    BlitBytes,
+    /// Paths and images a node recorded into the canvas, see VectorServer::get_path_count().
+    CanvasPaths,
+    Max,
+};
+
+const char *get_profile_counter_name(ProfileCounter counter);
+
+/// Records timed zones and per-node-type counters into a ring buffer, exportable as Chrome trace JSON
+/// (load it in chrome://tracing or Perfetto). Instrument code with the VECGUI_PROFILE_* macros, which compile to
+/// nothing unless VECGUI_PROFILER is defined.
+class Profiler {
+public:
+    static Profiler *get_singleton() {
+        static Profiler singleton;
+        return &singleton;
+    }
+
+    Profiler();
+
+    /// `name` must outlive the profiler, e.g. a string literal.
+    void record_zone(const char *name,
+                     std::chrono::steady_clock::time_point start,
+                     std::chrono::steady_clock::time_point end);
+
+    /// Thread-safe, so parallel passes can count too.
+    void count(NodeType type, ProfileCounter counter, uint32_t n = 1) {
+        counters_[(size_t)type][(size_t)counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// Record the whole frame as a zone, along with its non-zero counters, and reset the counters.
+    void end_frame();
+
+    /// Count of the last finished frame.
+    uint32_t get_frame_count(NodeType type, ProfileCounter counter) const;
+
+    /// Total time spent in each zone since the last clear(), including records the ring buffer has overwritten.
+    /// Nested zones are counted in their parents too.
+    std::vector<ProfileZoneTotal> get_zone_totals() const;
+
+    std::string to_chrome_trace_json() const;
+
+    bool export_chrome_trace(const std::string &path) const;
+
+    void clear();
+
+private:
+    struct Record {
+        const char *name;
+        /// Nanoseconds since the profiler was created.
+        int64_t start;
+        int64_t duration;
+        uint32_t thread_index;
+        /// Counter records have a node type and a value, zones have neither.
+        bool is_counter;
+        NodeType node_type;
+        uint32_t value;
+    };
+
+    void push(const Record &record);
+
+    int64_t to_profiler_time(std::chrono::steady_clock::time_point time) const;
+
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point frame_start_time_;
+
+    /// Ring buffer. Once full, the oldest records are overwritten.
+    std::vector<Record> records_;
+    size_t next_record_ = 0;
+
+    /// By zone name pointer, see get_zone_totals().
+    std::unordered_map<const char *, ProfileZoneTotal> zone_totals_;
+
+    mutable std::mutex mutex_;
+
+    std::array<std::array<std::atomic<uint32_t>, (size_t)ProfileCounter::Max>, (size_t)NodeType::Max> counters_{};
+
+    std::array<std::array<uint32_t, (size_t)ProfileCounter::Max>, (size_t)NodeType::Max> frame_counters_{};
+};
+
+/// Records the time from construction to destruction.
+class ProfileZone {
+public:
+    explicit ProfileZone(const char *name) : name_(name), start_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ProfileZone() {
+        Profiler::get_singleton()->record_zone(name_, start_, std::chrono::steady_clock::now());
+    }
+
+private:
+    const char *name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace vecgui
+
+#define VECGUI_PROFILE_CONCAT_INNER(a, b) a##b
+#define VECGUI_PROFILE_CONCAT(a, b) VECGUI_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef VECGUI_PROFILER
+    /// Time the rest of the enclosing scope.
+    #define VECGUI_PROFILE_ZONE(name) ::vecgui::ProfileZone VECGUI_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+    #define VECGUI_PROFILE_COUNT(type, counter) \
+        ::vecgui::Profiler::get_singleton()->count(type, ::vecgui::ProfileCounter::counter)
+    #define VECGUI_PROFILE_COUNT_N(type, counter, n) \
+        ::vecgui::Profiler::get_singleton()->count(type, ::vecgui::ProfileCounter::counter, n)
+    #define VECGUI_PROFILE_END_FRAME() ::vecgui::Profiler::get_singleton()->end_frame()
+#else
+    #define VECGUI_PROFILE_ZONE(name) (void)0
+    #define VECGUI_PROFILE_COUNT(type, counter) (void)0
+    #define VECGUI_PROFILE_COUNT_N(type, counter, n) (void)0
+    #define VECGUI_PROFILE_END_FRAME() (void)0
+#endif
@@ -1,10 +1,18 @@
 #pragma once
 
 #include <pathfinder/prelude.h>
+
+#include <cassert>
+#include <mutex>
+#include <vector>
+
 #include "../render/blit.h"
 
 namespace vecgui {
 
+/// Window indices are uint8_t, so this is the most windows there can be.
+constexpr size_t MAX_WINDOW_COUNT = 256;
+
 class RenderServer {
 public:
     static RenderServer *get_singleton() {
@@ -16,11 +24,59 @@ public:
         queue_.reset();
         device_.reset();
         window_builder_.reset();
+        headless_window_sizes_.clear();
+    }
+
+    /// Without a window builder, windows are virtual. See App::create_headless().
+    bool is_headless() const {
+        return window_builder_ == nullptr;
+    }
+
+    /// Register a virtual window. Pass an index to replace it (e.g. the primary window), or -1 to append one.
+    uint8_t create_headless_window(Vec2I logical_size, int window_index = -1) {
+        if (window_index < 0) {
+            window_index = headless_window_sizes_.size();
+        }
+        assert(window_index < MAX_WINDOW_COUNT && "Too many windows!");
+        if (window_index >= headless_window_sizes_.size()) {
+            headless_window_sizes_.resize(window_index + 1);
+        }
+        headless_window_sizes_[window_index] = logical_size;
+
+        return window_index;
+    }
+
+    Vec2I get_window_logical_size(uint8_t window_index) const {
+        if (is_headless()) {
+            return window_index < headless_window_sizes_.size() ? headless_window_sizes_[window_index] : Vec2I();
+        }
+
+        return window_builder_->get_window(window_index).lock()->get_logical_size();
+    }
+
+    float get_dpi_scaling_factor(uint8_t window_index) const {
+        if (is_headless()) {
+            return 1;
+        }
+
+        return window_builder_->get_dpi_scaling_factor(window_index);
     }
 
     std::shared_ptr<Pathfinder::WindowBuilder> window_builder_;
     std::shared_ptr<Pathfinder::Device> device_;
     std::shared_ptr<Pathfinder::Queue> queue_;
+
+    /// Held by the render thread while it draws and presents, see SceneTree::set_pipelined_rendering().
+    /// The main thread holds it too while it uses the device during a frame.
+    std::mutex gpu_mutex_;
+
+    /// Guards native windows and their swap chains. The main thread holds it while polling events, which resizes
+    /// windows, and while creating, showing or hiding them. The render thread holds it while it acquires and
+    /// presents swap chain images, which may recreate the swap chain. Take gpu_mutex_ first when both are needed.
+    std::mutex window_mutex_;
+
+private:
+    std::vector<Vec2I> headless_window_sizes_;
 };
 
 } // namespace vecgui
@@ -0,0 +1,125 @@
+#include "timer_server.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace vecgui {
+
+bool TimerServer::fires_later(const HeapEntry &a, const HeapEntry &b) {
+    if (a.deadline != b.deadline) {
+        return a.deadline > b.deadline;
+    }
+    return a.id > b.id;
+}
+
+TimerId TimerServer::start(double delay, const std::function<void()> &callback, double interval) {
+    auto id = next_id_++;
+    auto deadline = now_ + std::max(delay, 0.0);
+
+    timers_[id] = {deadline, interval, callback};
+    push_entry(deadline, id);
+
+    return id;
+}
+
+void TimerServer::stop(TimerId id) {
+    if (timers_.erase(id) == 0) {
+        return;
+    }
+
+    // Entries of stopped timers are left in the heap. Rebuild it once they outnumber the active ones.
+    if (heap_.size() > 2 * timers_.size() + 64) {
+        heap_.clear();
+        for (auto &[timer_id, timer] : timers_) {
+            heap_.push_back({timer.deadline, timer_id});
+        }
+        std::ranges::make_heap(heap_, fires_later);
+    }
+}
+
+bool TimerServer::is_active(TimerId id) const {
+    return timers_.contains(id);
+}
+
+double TimerServer::get_remaining_time(TimerId id) const {
+    auto it = timers_.find(id);
+    if (it == timers_.end()) {
+        return 0;
+    }
+
+    return std::max(it->second.deadline - now_, 0.0);
+}
+
+void TimerServer::tick(double dt) {
+    now_ += dt;
+
+    // Collect due timers first, so callbacks can freely start and stop timers.
+    std::vector<TimerId> due_timers;
+    while (!heap_.empty() && heap_.front().deadline <= now_) {
+        std::ranges::pop_heap(heap_, fires_later);
+        auto id = heap_.back().id;
+        heap_.pop_back();
+
+        if (timers_.contains(id)) {
+            due_timers.push_back(id);
+        }
+    }
+
+    for (auto id : due_timers) {
+        auto it = timers_.find(id);
+
+        // Stopped by an earlier callback.
+        if (it == timers_.end()) {
+            continue;
+        }
+
+        // Copy, as the callback may stop its own timer.
+        auto callback = it->second.callback;
+
+        if (it->second.interval > 0) {
+            auto &timer = it->second;
+            timer.deadline += timer.interval;
+            // Skip missed periods after a long frame instead of firing repeatedly.
+            if (timer.deadline <= now_) {
+                timer.deadline = now_ + timer.interval;
+            }
+            push_entry(timer.deadline, id);
+        } else {
+            timers_.erase(it);
+        }
+
+        callback();
+    }
+}
+
+void TimerServer::advance(double dt) {
+    now_ += dt;
+}
+
+double TimerServer::get_time_until_next_deadline() {
+    pop_stale_entries();
+
+    if (heap_.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return std::max(heap_.front().deadline - now_, 0.0);
+}
+
+size_t TimerServer::get_active_count() const {
+    return timers_.size();
+}
+
+void TimerServer::push_entry(double deadline, TimerId id) {
+    heap_.push_back({deadline, id});
+    std::ranges::push_heap(heap_, fires_later);
+}
+
+void TimerServer::pop_stale_entries() {
+    while (!heap_.empty() && !timers_.contains(heap_.front().id)) {
+        std::ranges::pop_heap(heap_, fires_later);
+        heap_.pop_back();
+    }
+}
+
+} // namespace vecgui
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace vecgui {
+
+/// Zero is never a valid timer.
+using TimerId = uint64_t;
+
+/// Fires callbacks at deadlines, so nodes don't have to count down in update().
+/// Timers live in a binary min-heap, stopped timers are dropped lazily.
+class TimerServer {
+public:
+    static TimerServer *get_singleton() {
+        static TimerServer singleton;
+        return &singleton;
+    }
+
+    /// Call `callback` after `delay` seconds, then every `interval` seconds if the interval is positive.
+    TimerId start(double delay, const std::function<void()> &callback, double interval = 0);
+
+    void stop(TimerId id);
+
+    bool is_active(TimerId id) const;
+
+    /// In seconds. Zero if the timer is not active.
+    double get_remaining_time(TimerId id) const;
+
+    /// Advance the clock and fire due timers, earliest first.
+    /// Timers started by these callbacks fire on a later tick at the earliest.
+    void tick(double dt);
+
+    /// Advance the clock without firing. Due timers fire on the next tick.
+    void advance(double dt);
+
+    /// Seconds until the earliest deadline, or infinity if there's no active timer.
+    /// Lets the main loop sleep while idle.
+    double get_time_until_next_deadline();
+
+    size_t get_active_count() const;
+
+private:
+    struct ActiveTimer {
+        double deadline;
+        double interval;
+        std::function<void()> callback;
+    };
+
+    struct HeapEntry {
+        double deadline;
+        TimerId id;
+    };
+
+    /// Heap comparator. Earlier deadlines first, then earlier started timers.
+    static bool fires_later(const HeapEntry &a, const HeapEntry &b);
+
+    void push_entry(double deadline, TimerId id);
+
+    /// Remove entries of stopped timers at the top of the heap.
+    void pop_stale_entries();
+
+    double now_ = 0;
+
+    TimerId next_id_ = 1;
+
+    std::unordered_map<TimerId, ActiveTimer> timers_;
+
+    std::vector<HeapEntry> heap_;
+};
+
+} // namespace vecgui
@@ -1,21 +1,95 @@
 #include "vector_server.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "../resources/default_resource.h"
 #include "engine.h"
+#include "profiler.h"
+#include "render_server.h"
 
 namespace vecgui {
 
 constexpr float STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT = 1.0;
 
+bool rects_overlap(const RectF &a, const RectF &b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+bool rect_contains(const RectF &outer, const RectF &inner) {
+    return outer.left <= inner.left && outer.top <= inner.top && inner.right <= outer.right &&
+           inner.bottom <= outer.bottom;
+}
+
+RectF inflate_rect(const RectF &rect, float amount) {
+    return {rect.left - amount, rect.top - amount, rect.right + amount, rect.bottom + amount};
+}
+
 void VectorServer::init(Pathfinder::Vec2I size,
                         const std::shared_ptr<Pathfinder::Device> &device,
                         const std::shared_ptr<Pathfinder::Queue> &queue,
                         Pathfinder::RenderLevel level) {
+    device_ = device;
+    queue_ = queue;
+    level_ = level;
+
     canvas = std::make_shared<Pathfinder::Canvas>(size, device, queue, level);
+
+    // The primary window.
+    window_canvases_.clear();
+    window_canvases_.push_back({canvas, size, nullptr});
 }
 
 void VectorServer::cleanup() {
+    layer_stack_.clear();
+    window_canvases_.clear();
+    scene_canvases_.clear();
+    dst_texture_.reset();
     canvas.reset();
+    queue_.reset();
+    device_.reset();
+}
+
+void VectorServer::select_window(uint8_t window_index,
+                                 Vec2I physical_size,
+                                 const std::shared_ptr<Pathfinder::Texture> &dst_texture) {
+    if (window_index >= window_canvases_.size()) {
+        window_canvases_.resize(window_index + 1);
+    }
+
+    auto &window_canvas = window_canvases_[window_index];
+
+    if (!window_canvas.canvas) {
+        std::lock_guard gpu_lock(RenderServer::get_singleton()->gpu_mutex_);
+        window_canvas.canvas = std::make_shared<Pathfinder::Canvas>(physical_size, device_, queue_, level_);
+        window_canvas.size = physical_size;
+    }
+
+    canvas = window_canvas.canvas;
+
+    if (window_canvas.size != physical_size) {
+        set_canvas_size(physical_size);
+        window_canvas.size = physical_size;
+    }
+
+    if (window_canvas.dst_texture != dst_texture) {
+        set_dst_texture(dst_texture);
+        window_canvas.dst_texture = dst_texture;
+    } else {
+        dst_texture_ = dst_texture;
+    }
+}
+
+void VectorServer::release_window(uint8_t window_index) {
+    // The current canvas is kept alive until another window is selected.
+    if (window_index < window_canvases_.size()) {
+        window_canvases_[window_index] = {};
+    }
+
+    std::lock_guard gpu_lock(RenderServer::get_singleton()->gpu_mutex_);
+    if (window_index < scene_canvases_.size()) {
+        scene_canvases_[window_index].reset();
+    }
 }
 
 void VectorServer::set_canvas_size(const Vec2I new_size) {
@@ -25,14 +99,43 @@ void VectorServer::set_canvas_size(const Vec2I new_size) {
 }
 
 void VectorServer::set_dst_texture(const std::shared_ptr<Pathfinder::Texture> &texture) {
+    dst_texture_ = texture;
     canvas->set_dst_texture(texture);
 }
 
 void VectorServer::submit_and_clear() {
+    VECGUI_PROFILE_ZONE("Canvas draw");
+
     canvas->draw(true);
     canvas->take_scene();
 }
 
+std::shared_ptr<Pathfinder::Scene> VectorServer::take_scene() {
+    return canvas->take_scene();
+}
+
+void VectorServer::draw_scene(uint8_t window_index,
+                              const std::shared_ptr<Pathfinder::Scene> &scene,
+                              const std::shared_ptr<Pathfinder::Texture> &dst_texture) {
+    VECGUI_PROFILE_ZONE("Canvas draw");
+
+    if (window_index >= scene_canvases_.size()) {
+        scene_canvases_.resize(window_index + 1);
+    }
+
+    auto &scene_canvas = scene_canvases_[window_index];
+    if (!scene_canvas) {
+        scene_canvas = std::make_shared<Pathfinder::Canvas>(dst_texture->get_size(), device_, queue_, level_);
+    }
+
+    scene_canvas->set_scene(scene);
+    scene_canvas->set_dst_texture(dst_texture);
+    scene_canvas->draw(true);
+
+    // Don't keep the frame alive.
+    scene_canvas->take_scene();
+}
+
 std::shared_ptr<Pathfinder::Canvas> VectorServer::get_canvas() const {
     return canvas;
 }
@@ -43,123 +146,356 @@ float VectorServer::get_global_scale() const {
 
 void VectorServer::set_global_scale(float new_scale) {
     global_scale_ = new_scale;
+
+    reset_transforms();
+}
+
+void VectorServer::reset_transforms() {
+    if (transform_stack_.size() > 1) {
+        Logger::error("Unbalanced transform stack!", "revector");
+    }
+
+    auto dpi_scaling_xform = Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+
+    transform_stack_.clear();
+    transform_stack_.push_back({Transform2(), dpi_scaling_xform, dpi_scaling_xform});
+}
+
+void VectorServer::push_transform(const Transform2 &transform) {
+    auto &parent = transform_stack_.back();
+
+    TransformLevel level;
+    level.to_global = parent.to_global * transform;
+    level.global_to_target = parent.global_to_target;
+    level.to_target = parent.to_target * transform;
+
+    transform_stack_.push_back(level);
+}
+
+void VectorServer::push_view_transform(const Transform2 &transform) {
+    auto &parent = transform_stack_.back();
+
+    TransformLevel level;
+    level.to_global = parent.to_global;
+    level.global_to_target = parent.global_to_target * transform;
+    level.to_target = level.global_to_target * level.to_global;
+
+    transform_stack_.push_back(level);
+}
+
+void VectorServer::push_target_origin(Vec2F origin) {
+    auto &parent = transform_stack_.back();
+
+    TransformLevel level;
+    level.to_global = parent.to_global;
+    level.global_to_target =
+        Transform2::from_scale(Vec2F(global_scale_, global_scale_)) * Transform2::from_translation(-origin);
+    level.to_target = level.global_to_target * level.to_global;
+
+    transform_stack_.push_back(level);
+}
+
+void VectorServer::pop_transform() {
+    if (transform_stack_.size() <= 1) {
+        Logger::error("Unbalanced transform stack!", "revector");
+        return;
+    }
+
+    transform_stack_.pop_back();
+}
+
+const Transform2 &VectorServer::get_transform() const {
+    return transform_stack_.back().to_global;
+}
+
+const Transform2 &VectorServer::get_global_to_target() const {
+    return transform_stack_.back().global_to_target;
+}
+
+void VectorServer::push_clip_rect(const RectF &rect, bool enforced) {
+    ClipRect clip{rect, !enforced};
+
+    if (!clip_stack_.empty()) {
+        auto &parent = clip_stack_.back();
+        clip.rect = parent.rect.intersection(rect);
+
+        // The parent's edge may still cut through the new rect.
+        if (parent.needs_clip_path && !rect_contains(parent.rect, rect)) {
+            clip.needs_clip_path = true;
+        }
+    }
+
+    clip_stack_.push_back(clip);
+}
+
+void VectorServer::pop_clip_rect() {
+    if (clip_stack_.empty()) {
+        Logger::error("Unbalanced clip rect stack!", "revector");
+        return;
+    }
+
+    clip_stack_.pop_back();
+}
+
+bool VectorServer::is_rect_visible(const RectF &rect) const {
+    if (clip_stack_.empty()) {
+        return true;
+    }
+
+    // The intersection may be empty, in which case it's inverted.
+    auto &clip = clip_stack_.back().rect;
+    return clip.left < clip.right && clip.top < clip.bottom && rects_overlap(clip, rect);
+}
+
+bool VectorServer::is_local_rect_visible(const RectF &rect) const {
+    if (clip_stack_.empty()) {
+        return true;
+    }
+
+    return is_rect_visible(get_transform() * rect);
+}
+
+void VectorServer::begin_layer(const std::shared_ptr<Pathfinder::Texture> &texture, Vec2F origin) {
+    layer_stack_.push_back({canvas->take_scene(), dst_texture_, transform_stack_, std::move(clip_stack_)});
+    clip_stack_.clear();
+
+    auto view_box = RectI({}, texture->get_size()).to_f32();
+    canvas->get_scene()->set_bounds(view_box);
+    canvas->get_scene()->set_view_box(view_box);
+
+    set_dst_texture(texture);
+
+    // Popped along with the rest of the stack by end_layer().
+    push_target_origin(origin);
+}
+
+void VectorServer::end_layer() {
+    if (layer_stack_.empty()) {
+        Logger::error("end_layer() without begin_layer()!", "revector");
+        return;
+    }
+
+    {
+        VECGUI_PROFILE_ZONE("Layer draw");
+        std::lock_guard gpu_lock(RenderServer::get_singleton()->gpu_mutex_);
+        canvas->draw(true);
+    }
+
+    auto &state = layer_stack_.back();
+
+    canvas->set_scene(state.scene);
+    set_dst_texture(state.dst_texture);
+    transform_stack_ = std::move(state.transform_stack);
+    clip_stack_ = std::move(state.clip_stack);
+
+    layer_stack_.pop_back();
+}
+
+bool VectorServer::needs_clip_path(const std::optional<RectF> &bounds) const {
+    if (clip_stack_.empty()) {
+        return false;
+    }
+
+    auto &clip = clip_stack_.back();
+    return clip.needs_clip_path && !(bounds && rect_contains(clip.rect, get_transform() * *bounds));
+}
+
+void VectorServer::apply_clip_path() {
+    auto clip_path = Pathfinder::Path2d();
+    clip_path.add_rect(clip_stack_.back().rect, 0);
+    canvas->set_transform(get_global_to_target());
+    canvas->clip_path(clip_path, Pathfinder::FillRule::Winding);
 }
 
+void VectorServer::fill_path(const Pathfinder::Path2d &path, Pathfinder::FillRule fill_rule) {
+    path_count_++;
+    canvas->fill_path(path, fill_rule);
+}
+
+void VectorServer::stroke_path(const Pathfinder::Path2d &path) {
+    path_count_++;
+    canvas->stroke_path(path);
+}
+
+uint64_t VectorServer::get_path_count() const {
+    return path_count_;
+}
+
+/// Draws overwrite the canvas state they use, so the state only has to be saved for what they can't undo: clip paths
+/// and shadows.
+class CanvasStateScope {
+public:
+    CanvasStateScope(Pathfinder::Canvas &canvas, bool save) : canvas_(canvas), saved_(save) {
+        if (saved_) {
+            canvas_.save_state();
+        }
+    }
+
+    ~CanvasStateScope() {
+        if (saved_) {
+            canvas_.restore_state();
+        }
+    }
+
+private:
+    Pathfinder::Canvas &canvas_;
+    bool saved_;
+};
+
 void VectorServer::draw_line(Vec2F start, Vec2F end, float width, ColorU color) {
-    canvas->save_state();
+    auto bounds = inflate_rect(RectF(start, start).union_rect(RectF(end, end)), width);
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
+
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
     Pathfinder::Path2d path;
     path.add_line({start.x, start.y}, {end.x, end.y});
 
-    canvas->set_transform(Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_)));
+    canvas->set_transform(transform_stack_.back().to_target);
 
     canvas->set_stroke_paint(Pathfinder::Paint::from_color(color));
     canvas->set_line_width(width);
     // canvas->set_line_cap(Pathfinder::LineCap::Round);
-    canvas->stroke_path(path);
-
-    canvas->restore_state();
+    stroke_path(path);
 }
 
 void VectorServer::draw_rectangle(const RectF &rect, float line_width, ColorU color, bool fill) {
-    canvas->save_state();
+    auto bounds = inflate_rect(rect, line_width);
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
+
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
     Pathfinder::Path2d path;
     path.add_rect(rect);
 
-    canvas->set_transform(Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_)));
+    canvas->set_transform(transform_stack_.back().to_target);
 
     if (fill) {
         canvas->set_fill_paint(Pathfinder::Paint::from_color(color));
-        canvas->fill_path(path, Pathfinder::FillRule::Winding);
+        fill_path(path, Pathfinder::FillRule::Winding);
     } else {
         canvas->set_stroke_paint(Pathfinder::Paint::from_color(color));
         canvas->set_line_width(line_width);
-        canvas->stroke_path(path);
+        stroke_path(path);
     }
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_circle(Vec2F center, float radius, float line_width, bool fill, ColorU color) {
-    canvas->save_state();
+    auto bounds = inflate_rect(RectF(center, center), radius + line_width);
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
+
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
     Pathfinder::Path2d path;
     path.add_circle(center, radius);
 
-    canvas->set_transform(Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_)));
+    canvas->set_transform(transform_stack_.back().to_target);
 
     if (fill) {
         canvas->set_fill_paint(Pathfinder::Paint::from_color(color));
-        canvas->fill_path(path, Pathfinder::FillRule::Winding);
+        fill_path(path, Pathfinder::FillRule::Winding);
     }
     if (line_width > Pathfinder::FLOAT_EPSILON) { // Ignore too small width
         canvas->set_stroke_paint(Pathfinder::Paint::from_color(color));
         canvas->set_line_width(line_width);
-        canvas->stroke_path(path);
+        stroke_path(path);
     }
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_path(VectorPath &vector_path, Transform2 transform) {
-    canvas->save_state();
-
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    // The path bounds are unknown, callers reject what they can.
+    bool clipped = needs_clip_path(std::nullopt);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
-    canvas->set_transform(dpi_scaling_xform * global_transform_offset * transform);
+    canvas->set_transform(transform_stack_.back().to_target * transform);
 
     if (vector_path.fill_color.is_opaque()) {
         canvas->set_fill_paint(Pathfinder::Paint::from_color(vector_path.fill_color));
-        canvas->fill_path(vector_path.path2d, Pathfinder::FillRule::Winding);
+        fill_path(vector_path.path2d, Pathfinder::FillRule::Winding);
     }
 
     if (vector_path.stroke_width > 0) {
         canvas->set_stroke_paint(Pathfinder::Paint::from_color(vector_path.stroke_color));
         canvas->set_line_width(vector_path.stroke_width);
-        canvas->stroke_path(vector_path.path2d);
+        stroke_path(vector_path.path2d);
     }
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_raster_image(const RasterImage &image, const Transform2 &transform) {
-    canvas->save_state();
+    auto image_data = image.image_data;
 
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    auto bounds = transform * RectF({}, image_data->size.to_f32());
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
 
-    canvas->set_transform(dpi_scaling_xform * global_transform_offset * transform);
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
-    auto image_data = image.image_data;
+    canvas->set_transform(transform_stack_.back().to_target * transform);
 
+    path_count_++;
     canvas->draw_image(image_data, RectF({}, Vec2F() + image_data->size.to_f32()));
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_vector_image(VectorImage &image, Transform2 transform) {
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    if (!is_local_rect_visible(transform * RectF({}, image.get_size().to_f32()))) {
+        return;
+    }
+
+    push_transform(transform);
 
     for (auto &path : image.get_paths()) {
-        draw_path(path, dpi_scaling_xform * transform);
+        draw_path(path, Transform2());
     }
 
     if (image.get_svg_scene()) {
-        canvas->get_scene()->append_scene(*image.get_svg_scene()->get_scene(),
-                                          dpi_scaling_xform * global_transform_offset * transform);
+        canvas->get_scene()->append_scene(*image.get_svg_scene()->get_scene(), transform_stack_.back().to_target);
     }
+
+    pop_transform();
 }
 
 void VectorServer::draw_render_image(RenderImage &render_image, Transform2 transform) {
-    canvas->save_state();
+    auto bounds = transform * RectF({}, render_image.get_size().to_f32());
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
 
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
-    canvas->set_transform(dpi_scaling_xform * global_transform_offset * transform);
+    canvas->set_transform(transform_stack_.back().to_target * transform);
 
+    path_count_++;
     canvas->draw_raw_texture(render_image.get_texture(), RectF({}, render_image.get_size().to_f32()));
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_style_box(const StyleBox &style_box, Vec2F position, Vec2F size, float alpha) {
@@ -179,6 +515,19 @@ void VectorServer::draw_style_box(const StyleBox &style_box, Vec2F position, Vec
         }
     }
 
+    // Shadows are drawn outside the box.
+    auto shadow_extent =
+        style_box.shadow_size + std::max(std::abs(style_box.shadow_offset.x), std::abs(style_box.shadow_offset.y));
+    auto bounds = inflate_rect(RectF(position, position + size), shadow_extent + style_box.border_width);
+    if (style_box.border_widths.has_value()) {
+        const auto widths = style_box.border_widths.value();
+        bounds = inflate_rect(bounds, std::max({widths.left, widths.right, widths.top, widths.bottom}));
+    }
+
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
+
     auto path = Pathfinder::Path2d();
     if (style_box.corner_radii.has_value()) {
         path.add_rect_with_corners({{}, size}, style_box.corner_radii.value());
@@ -186,18 +535,23 @@ void VectorServer::draw_style_box(const StyleBox &style_box, Vec2F position, Vec
         path.add_rect({{}, size}, style_box.corner_radius);
     }
 
-    canvas->save_state();
+    bool clipped = needs_clip_path(bounds);
+    bool has_shadow = style_box.shadow_color.a_ > 0;
 
-    canvas->set_shadow_color(style_box.shadow_color);
-    canvas->set_shadow_blur(style_box.shadow_size);
+    CanvasStateScope state_scope(*canvas, clipped || has_shadow);
+    if (clipped) {
+        apply_clip_path();
+    }
 
-    const auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    if (has_shadow) {
+        canvas->set_shadow_color(style_box.shadow_color);
+        canvas->set_shadow_blur(style_box.shadow_size);
+    }
 
-    const auto transform = Pathfinder::Transform2::from_translation(position);
-    canvas->set_transform(dpi_scaling_xform * global_transform_offset * transform);
+    canvas->set_transform(transform_stack_.back().to_target * Transform2::from_translation(position));
 
     canvas->set_fill_paint(Pathfinder::Paint::from_color(style_box.bg_color.apply_alpha(alpha)));
-    canvas->fill_path(path, Pathfinder::FillRule::Winding);
+    fill_path(path, Pathfinder::FillRule::Winding);
 
     if (style_box.border_widths.has_value()) {
         const auto widths = style_box.border_widths.value();
@@ -206,52 +560,55 @@ void VectorServer::draw_style_box(const StyleBox &style_box, Vec2F position, Vec
             line.add_line({}, Vec2F(0, size.y));
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_box.border_color.apply_alpha(alpha)));
             canvas->set_line_width(widths.left);
-            canvas->stroke_path(line);
+            stroke_path(line);
         }
         if (widths.right > 0) {
             auto line = Pathfinder::Path2d();
             line.add_line(Vec2F(0, size.x), size);
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_box.border_color.apply_alpha(alpha)));
             canvas->set_line_width(widths.right);
-            canvas->stroke_path(line);
+            stroke_path(line);
         }
         if (widths.top > 0) {
             auto line = Pathfinder::Path2d();
             line.add_line({}, Vec2F(size.x, 0));
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_box.border_color.apply_alpha(alpha)));
             canvas->set_line_width(widths.top);
-            canvas->stroke_path(line);
+            stroke_path(line);
         }
         if (widths.bottom > 0) {
             auto line = Pathfinder::Path2d();
             line.add_line(Vec2F(0, size.y), Vec2F(0, size.y));
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_box.border_color.apply_alpha(alpha)));
             canvas->set_line_width(widths.bottom);
-            canvas->stroke_path(line);
+            stroke_path(line);
         }
     } else if (style_box.border_width > 0) {
         canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_box.border_color.apply_alpha(alpha)));
         canvas->set_line_width(style_box.border_width);
-        canvas->stroke_path(path);
+        stroke_path(path);
     }
-
-    canvas->restore_state();
 }
 
 void VectorServer::draw_style_line(const StyleLine &style_line, const Vec2F &start, const Vec2F &end) {
+    auto bounds = inflate_rect(RectF(start, start).union_rect(RectF(end, end)), style_line.width);
+    if (!is_local_rect_visible(bounds)) {
+        return;
+    }
+
     auto path = Pathfinder::Path2d();
     path.add_line(start, end);
 
-    canvas->save_state();
-
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    bool clipped = needs_clip_path(bounds);
+    CanvasStateScope state_scope(*canvas, clipped);
+    if (clipped) {
+        apply_clip_path();
+    }
 
-    canvas->set_transform(dpi_scaling_xform * global_transform_offset);
+    canvas->set_transform(transform_stack_.back().to_target);
     canvas->set_stroke_paint(Pathfinder::Paint::from_color(style_line.color));
     canvas->set_line_width(style_line.width);
-    canvas->stroke_path(path);
-
-    canvas->restore_state();
+    stroke_path(path);
 }
 
 void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
@@ -268,15 +625,51 @@ void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
     text_style.color = text_style.color.apply_alpha(alpha);
     text_style.stroke_color = text_style.stroke_color.apply_alpha(alpha);
 
+    auto &to_target = transform_stack_.back().to_target;
+
+    // Local transforms of the glyphs, each computed once for culling and both passes.
+    glyph_transforms_.resize(glyphs.size());
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        glyph_transforms_[i] = {Transform2::from_translation(glyph_positions[i]) * transform *
+                                    Transform2::from_translation({0, glyphs[i].ascent}),
+                                true};
+    }
+
+    // Reject the whole run on the CPU if possible, and clip it once otherwise.
+    std::optional<RectF> run_bounds;
+    if (!clip_stack_.empty()) {
+        auto margin = text_style.stroke_width + STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT;
+
+        for (size_t i = 0; i < glyphs.size(); i++) {
+            // Local bounds of the glyph, with room for strokes and italic skew.
+            auto &g = glyphs[i];
+            auto glyph_bounds = g.box.union_rect(g.bbox);
+            auto glyph_margin = margin;
+            if (text_style.italic) {
+                glyph_margin += glyph_bounds.height() * 0.3f;
+            }
+            glyph_bounds = inflate_rect(glyph_transforms_[i].transform * glyph_bounds, glyph_margin);
+
+            glyph_transforms_[i].visible = is_local_rect_visible(glyph_bounds);
+            run_bounds = run_bounds ? run_bounds->union_rect(glyph_bounds) : glyph_bounds;
+        }
+        if (!run_bounds || !is_local_rect_visible(*run_bounds)) {
+            return;
+        }
+    }
+
+    // Line joins aren't set by other draws, so the state is always restored.
     canvas->save_state();
 
-    auto dpi_scaling_xform = Pathfinder::Transform2::from_scale(Vec2F(global_scale_, global_scale_));
+    if (needs_clip_path(run_bounds)) {
+        apply_clip_path();
+    }
 
     // Text clip.
     if (clip_box.is_valid()) {
         auto clip_path = Pathfinder::Path2d();
         clip_path.add_rect(clip_box, 0);
-        canvas->set_transform(dpi_scaling_xform * global_transform_offset * transform);
+        canvas->set_transform(to_target * transform);
         canvas->clip_path(clip_path, Pathfinder::FillRule::Winding);
     }
 
@@ -285,63 +678,63 @@ void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
         skew_xform = Transform2({1, 0, std::tan(-15.f * 3.1415926f / 180.f), 1}, {});
     }
 
-    // Draw glyph strokes. The strokes go below the fills.
-    for (int i = 0; i < glyphs.size(); i++) {
+    // The glyphs of a run share their paints, so they are merged into one path, pre-transformed into the local
+    // space, and each pass draws it at once. A paragraph is then a few canvas paths instead of several per glyph.
+    Pathfinder::Path2d batch;
+    bool batch_empty = true;
+
+    for (size_t i = 0; i < glyphs.size(); i++) {
         auto &g = glyphs[i];
-        auto &p = glyph_positions[i];
 
-        if (g.emoji || g.skip_drawing) {
+        if (g.emoji || g.skip_drawing || !glyph_transforms_[i].visible) {
             continue;
         }
 
-        auto baseline_xform = Transform2::from_translation({0, g.ascent});
+        batch.add_path(g.path, glyph_transforms_[i].transform * skew_xform);
+        batch_empty = false;
+    }
 
-        auto glyph_global_transform =
-            dpi_scaling_xform * global_transform_offset * Transform2::from_translation(p) * transform * baseline_xform;
+    if (!batch_empty) {
+        canvas->set_transform(to_target);
 
-        canvas->set_transform(glyph_global_transform * skew_xform);
+        // Draw glyph strokes. The strokes go below the fills.
+        if (text_style.stroke_width > 0 || text_style.bold) {
+            float stroke_width = text_style.stroke_width;
+            if (text_style.bold) {
+                stroke_width += STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT;
+            }
 
-        // Add stroke if needed.
-        canvas->set_stroke_paint(Pathfinder::Paint::from_color(text_style.stroke_color));
-        float stroke_width = text_style.stroke_width;
+            canvas->set_stroke_paint(Pathfinder::Paint::from_color(text_style.stroke_color));
+            canvas->set_line_width(stroke_width);
+            canvas->set_line_join(Pathfinder::LineJoin::Round);
+            stroke_path(batch);
+        }
+
+        // Draw glyph fills.
+        canvas->set_fill_paint(Pathfinder::Paint::from_color(text_style.color));
+        fill_path(batch, Pathfinder::FillRule::Winding);
+
+        // Use stroke to make a pseudo bold effect.
         if (text_style.bold) {
-            stroke_width += STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT;
+            canvas->set_stroke_paint(Pathfinder::Paint::from_color(text_style.color));
+            canvas->set_line_width(STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT);
+            canvas->set_line_join(Pathfinder::LineJoin::Bevel);
+            stroke_path(batch);
         }
-        canvas->set_line_width(stroke_width);
-        canvas->set_line_join(Pathfinder::LineJoin::Round);
-        canvas->stroke_path(g.path);
     }
 
-    // Draw glyph fills.
-    for (int i = 0; i < glyphs.size(); i++) {
+    // Emojis are scenes of their own, and debug boxes are drawn per glyph.
+    for (size_t i = 0; i < glyphs.size(); i++) {
         auto &g = glyphs[i];
-        auto &p = glyph_positions[i];
 
-        if (g.skip_drawing) {
+        if (g.skip_drawing || !glyph_transforms_[i].visible || !(g.emoji || text_style.debug)) {
             continue;
         }
 
-        auto baseline_xform = Transform2::from_translation({0, g.ascent});
-
         // No italic for emojis and debug boxes.
-        auto glyph_global_transform =
-            dpi_scaling_xform * global_transform_offset * Transform2::from_translation(p) * transform * baseline_xform;
+        auto glyph_target_transform = to_target * glyph_transforms_[i].transform;
 
-        if (!g.emoji) {
-            canvas->set_transform(glyph_global_transform * skew_xform);
-
-            // Add fill.
-            canvas->set_fill_paint(Pathfinder::Paint::from_color(text_style.color));
-            canvas->fill_path(g.path, Pathfinder::FillRule::Winding);
-
-            // Use stroke to make a pseudo bold effect.
-            if (text_style.bold) {
-                canvas->set_stroke_paint(Pathfinder::Paint::from_color(text_style.color));
-                canvas->set_line_width(STROKE_WIDTH_FOR_PSEUDO_BOLD_TEXT);
-                canvas->set_line_join(Pathfinder::LineJoin::Bevel);
-                canvas->stroke_path(g.path);
-            }
-        } else {
+        if (g.emoji) {
             auto svg_scene = std::make_shared<Pathfinder::SvgScene>(g.svg, *canvas);
 
             // The emoji's svg size is always fixed for a specific font no matter what the font size you set.
@@ -350,11 +743,11 @@ void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
 
             auto emoji_scale = Transform2::from_scale(glyph_size / svg_size);
 
-            canvas->get_scene()->append_scene(*(svg_scene->get_scene()), glyph_global_transform * emoji_scale);
+            canvas->get_scene()->append_scene(*(svg_scene->get_scene()), glyph_target_transform * emoji_scale);
         }
 
         if (text_style.debug) {
-            canvas->set_transform(glyph_global_transform);
+            canvas->set_transform(glyph_target_transform);
             canvas->set_line_width(1);
 
             // Add box.
@@ -363,7 +756,7 @@ void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
             layout_path.add_rect(g.box);
 
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(ColorU::green()));
-            canvas->stroke_path(layout_path);
+            stroke_path(layout_path);
             // --------------------------------
 
             // Add bbox.
@@ -372,7 +765,7 @@ void VectorServer::draw_glyphs(std::vector<Glyph> &glyphs,
             bbox_path.add_rect(g.bbox);
 
             canvas->set_stroke_paint(Pathfinder::Paint::from_color(ColorU::red()));
-            canvas->stroke_path(bbox_path);
+            stroke_path(bbox_path);
             // --------------------------------
         }
     }
@@ -390,6 +783,11 @@ std::string replace_all(std::string str, const std::string &from, const std::str
 }
 
 std::shared_ptr<Pathfinder::SvgScene> VectorServer::load_svg(const std::string &path, bool override_with_accent_color) {
+    // Headless without a device.
+    if (canvas == nullptr) {
+        return nullptr;
+    }
+
 #ifndef __ANDROID__
     auto bytes = Pathfinder::load_file_as_bytes(path);
 #else
@@ -2,6 +2,9 @@
 
 #include <pathfinder/prelude.h>
 
+#include <optional>
+#include <vector>
+
 #include "../common/geometry.h"
 #include "../resources/font.h"
 #include "../resources/raster_image.h"
@@ -28,12 +31,56 @@ public:
 
     void set_dst_texture(const std::shared_ptr<Pathfinder::Texture> &texture);
 
+    /// Draw into the canvas of a window until another one is selected. Each window has its own canvas and scene,
+    /// created on first use, so windows of different sizes don't resize a shared canvas back and forth.
+    /// `physical_size` and `dst_texture` are only applied if they changed.
+    void select_window(uint8_t window_index,
+                       Vec2I physical_size,
+                       const std::shared_ptr<Pathfinder::Texture> &dst_texture);
+
+    /// Free the canvas of a closed window.
+    void release_window(uint8_t window_index);
+
     void cleanup();
 
     void set_canvas_size(Vec2I new_size);
 
     void submit_and_clear();
 
+    /// Take what has been drawn into the current canvas so far, leaving it empty. The scene isn't touched
+    /// afterwards, so it can be drawn with draw_scene() on another thread while the next frame is recorded.
+    std::shared_ptr<Pathfinder::Scene> take_scene();
+
+    /// Tile and render a taken scene of a window into a texture. Uses a canvas of its own per window, apart from
+    /// the one drawn into, so call it with RenderServer::gpu_mutex_ held and from one thread at a time.
+    void draw_scene(uint8_t window_index,
+                    const std::shared_ptr<Pathfinder::Scene> &scene,
+                    const std::shared_ptr<Pathfinder::Texture> &dst_texture);
+
+    /// Transform everything drawn until the matching pop_transform() by `transform`, after the current transform.
+    /// A node can push its global transform once and then draw in its local space. Levels cache their composed
+    /// matrices, so draws don't rebuild the chain.
+    void push_transform(const Transform2 &transform);
+
+    /// Transform what's drawn until the matching pop_transform() by `transform`, in global logical coordinates, e.g.
+    /// the rotation of a node, see NodeUi::get_view_transform(). Unlike push_transform(), clip rects and culling
+    /// stay in the untransformed coordinates nodes are laid out in, and render targets pushed later start over
+    /// without it, as they are transformed as a whole.
+    void push_view_transform(const Transform2 &transform);
+
+    /// Draw into a render target with `origin`, in global logical coordinates, at its top-left until the matching
+    /// pop_transform(). Transforms pushed before still apply.
+    void push_target_origin(Vec2F origin);
+
+    void pop_transform();
+
+    /// From the current local space to global logical coordinates.
+    const Transform2 &get_transform() const;
+
+    /// From global logical coordinates to pixels of whatever is being drawn into.
+    const Transform2 &get_global_to_target() const;
+
+    /// Primitives are drawn in the current local space, see push_transform().
     void draw_line(Vec2F start, Vec2F end, float width, ColorU color);
 
     void draw_rectangle(const RectF &rect, float line_width, ColorU color, bool fill);
@@ -52,12 +99,30 @@ public:
 
     void draw_style_line(const StyleLine &style_line, const Vec2F &start, const Vec2F &end);
 
+    /// Clip everything drawn until the matching pop_clip_rect() to a rect in global logical coordinates,
+    /// intersected with the current clip rect. Draws entirely outside are rejected on the CPU.
+    /// Pass `enforced` if pixels outside are discarded anyway, e.g. by a render target of that size.
+    /// Otherwise, draws crossing the edge get a clip path.
+    void push_clip_rect(const RectF &rect, bool enforced = false);
+
+    void pop_clip_rect();
+
+    /// If anything inside a rect, in global logical coordinates, can show through the current clip rect.
+    bool is_rect_visible(const RectF &rect) const;
+
+    /// Redirect drawing into an offscreen texture until end_layer(), with `origin`, in global logical coordinates,
+    /// at its top-left. Clip rects pushed before don't apply inside. Layers can nest.
+    void begin_layer(const std::shared_ptr<Pathfinder::Texture> &texture, Vec2F origin);
+
+    /// Render everything drawn since begin_layer() into its texture, then resume drawing where it left off.
+    void end_layer();
+
     /**
      * @param transform
      * @param clip_box Enable content clip, portion of anything drawn afterward
      * outside the clip box will not show. The rect is in local coordinates, and the transform will be applied to it.
-     * We shouldn't use a clip path to achieve general content clip (like scrolling)
-     * since it's quite performance heavy and easily produces nested clipping.
+     * This uses a clip path, so it's meant for rotated or skewed text. For axis-aligned clipping (like scrolling),
+     * use push_clip_rect(), which is cheaper and doesn't nest clip paths.
      */
     void draw_glyphs(std::vector<Glyph> &glyphs,
                      std::vector<Vec2F> &glyph_positions,
@@ -66,22 +131,101 @@ public:
                      const RectF &clip_box,
                      float alpha = 1.0f);
 
+    /// Paths and images recorded into canvases so far, for profiling. Batched glyphs count once per batch.
+    uint64_t get_path_count() const;
+
     std::shared_ptr<Pathfinder::SvgScene> load_svg(const std::string &path, bool override_with_accent_color = false);
 
     std::shared_ptr<Pathfinder::Canvas> get_canvas() const;
 
     float get_global_scale() const;
 
+    /// Also resets the transform stack, so call it before drawing a window.
     void set_global_scale(float new_scale);
 
-    // Only used with ScrollContainer.
-    Transform2 global_transform_offset{};
-
 private:
+    struct ClipRect {
+        RectF rect;
+        /// If the rect is not enforced by a render target, so draws crossing its edge need a clip path.
+        bool needs_clip_path;
+    };
+
+    struct TransformLevel {
+        /// From the local space to global logical coordinates, for clipping.
+        Transform2 to_global;
+        /// DPI scaling, the target origin and view transforms.
+        Transform2 global_to_target;
+        /// The two composed, what draws use.
+        Transform2 to_target;
+    };
+
+    /// Clear the transform stack down to the DPI scaling.
+    void reset_transforms();
+
+    /// is_rect_visible() for a rect in the current local space.
+    bool is_local_rect_visible(const RectF &rect) const;
+
+    /// Whether a draw with `bounds`, in the current local space, needs a clip path, in which case it has to be done
+    /// between save_state() and restore_state().
+    bool needs_clip_path(const std::optional<RectF> &bounds) const;
+
+    /// Set the clip path of the current clip rect, see needs_clip_path().
+    void apply_clip_path();
+
+    /// Record into the current canvas, counting paths.
+    void fill_path(const Pathfinder::Path2d &path, Pathfinder::FillRule fill_rule);
+
+    void stroke_path(const Pathfinder::Path2d &path);
+
     // Never expose this.
     std::shared_ptr<Pathfinder::Canvas> canvas;
 
+    struct WindowCanvas {
+        std::shared_ptr<Pathfinder::Canvas> canvas;
+        Vec2I size;
+        std::shared_ptr<Pathfinder::Texture> dst_texture;
+    };
+
+    /// By window index. The current canvas is one of them.
+    std::vector<WindowCanvas> window_canvases_;
+
+    /// By window index, only used by draw_scene().
+    std::vector<std::shared_ptr<Pathfinder::Canvas>> scene_canvases_;
+
+    std::shared_ptr<Pathfinder::Device> device_;
+    std::shared_ptr<Pathfinder::Queue> queue_;
+    Pathfinder::RenderLevel level_{};
+
+    /// Innermost last. Each entry is already intersected with the ones below.
+    std::vector<ClipRect> clip_stack_;
+
+    /// Innermost last, never empty.
+    std::vector<TransformLevel> transform_stack_{TransformLevel{}};
+
+    struct GlyphTransform {
+        /// From the glyph's space to the current local space.
+        Transform2 transform;
+        bool visible;
+    };
+
+    /// Scratch space of draw_glyphs(), kept to avoid an allocation per run.
+    std::vector<GlyphTransform> glyph_transforms_;
+
+    std::shared_ptr<Pathfinder::Texture> dst_texture_;
+
+    /// What begin_layer() interrupted.
+    struct LayerState {
+        std::shared_ptr<Pathfinder::Scene> scene;
+        std::shared_ptr<Pathfinder::Texture> dst_texture;
+        std::vector<TransformLevel> transform_stack;
+        std::vector<ClipRect> clip_stack;
+    };
+
+    std::vector<LayerState> layer_stack_;
+
     float global_scale_ = 1.0f;
+
+    uint64_t path_count_ = 0;
 };
 
 } // namespace vecgui
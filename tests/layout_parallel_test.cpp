@@ -0,0 +1,233 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+#include "app.h"
+#include "servers/profiler.h"
+
+using namespace vecgui;
+
+/// Lays out the same random trees with a serial and with a parallel layout pass, see LAYOUT_PARALLEL_GRAIN_SIZE,
+/// and checks that every frame ends with the same positions, sizes, bounds and dirty flags, after the same number of
+/// relayouts. The scenes change between frames, so partial relayouts and the walks deferred by the parallel pass
+/// are covered too. Relayouts are only counted with VECGUI_PROFILER.
+///
+/// Usage: vecgui_layout_parallel_test. Returns non-zero on a mismatch.
+
+const Vec2I TEST_WINDOW_SIZE = {1280, 720};
+
+constexpr uint32_t TEST_SEED_COUNT = 8;
+
+constexpr uint32_t TEST_FRAMES = 20;
+
+/// Small, so trees are split into many parallel subtrees.
+constexpr uint32_t TEST_PARALLEL_GRAIN_SIZE = 8;
+
+constexpr uint32_t TEST_TREE_DEPTH = 5;
+
+/// Per frame.
+constexpr uint32_t TEST_CHANGES = 16;
+
+struct NodeLayout {
+    Vec2F position;
+    Vec2F size;
+    Vec2F global_position;
+    RectF global_bounds;
+    bool layout_dirty;
+    bool transform_dirty;
+    bool transform_pending;
+};
+
+struct FrameLayout {
+    std::vector<NodeLayout> nodes;
+    uint32_t relayouts = 0;
+};
+
+struct TestScene {
+    /// In creation order, which only depends on the seed.
+    std::vector<std::shared_ptr<NodeUi>> nodes;
+    std::vector<std::shared_ptr<NodeUi>> leaves;
+    std::vector<std::shared_ptr<BoxContainer>> boxes;
+};
+
+ContainerSizingFlag get_random_sizing_flag(std::mt19937 &rng) {
+    return (ContainerSizingFlag)std::uniform_int_distribution<int>(0, (int)ContainerSizingFlag::ShrinkEnd)(rng);
+}
+
+Vec2F get_random_size(std::mt19937 &rng) {
+    std::uniform_int_distribution<int> extent(0, 64);
+    return Vec2F(extent(rng), extent(rng));
+}
+
+std::shared_ptr<NodeUi> build_random_subtree(TestScene &scene, std::mt19937 &rng, uint32_t depth) {
+    std::shared_ptr<NodeUi> node;
+
+    if (depth == TEST_TREE_DEPTH) {
+        if (rng() % 2) {
+            auto label = std::make_shared<Label>();
+            label->set_text(std::string(1 + rng() % 16, 'a' + rng() % 26));
+            node = label;
+        } else {
+            node = std::make_shared<Panel>();
+        }
+        node->set_custom_minimum_size(get_random_size(rng));
+        scene.leaves.push_back(node);
+    } else {
+        std::shared_ptr<Container> container;
+
+        switch (rng() % 4) {
+            case 0: {
+                auto box = std::make_shared<HBoxContainer>();
+                box->set_separation(rng() % 8);
+                scene.boxes.push_back(box);
+                container = box;
+            } break;
+            case 1: {
+                auto box = std::make_shared<VBoxContainer>();
+                box->set_separation(rng() % 8);
+                scene.boxes.push_back(box);
+                container = box;
+            } break;
+            case 2: {
+                auto margin_container = std::make_shared<MarginContainer>();
+                margin_container->set_margin_all(rng() % 8);
+                container = margin_container;
+            } break;
+            default: {
+                auto grid = std::make_shared<GridContainer>();
+                grid->set_column_limit(1 + rng() % 4);
+                container = grid;
+            } break;
+        }
+
+        node = container;
+
+        // Rotated subtrees are retransformed as a whole.
+        if (rng() % 8 == 0) {
+            container->set_rotation(0.1f * (rng() % 8));
+            container->set_scale(Vec2F(1.0f + 0.25f * (rng() % 3)));
+        }
+
+        uint32_t child_count = 2 + rng() % 5;
+        for (uint32_t i = 0; i < child_count; i++) {
+            container->add_child(build_random_subtree(scene, rng, depth + 1));
+        }
+    }
+
+    node->container_sizing.flag_h = get_random_sizing_flag(rng);
+    node->container_sizing.flag_v = get_random_sizing_flag(rng);
+
+    scene.nodes.push_back(node);
+
+    return node;
+}
+
+uint32_t get_frame_relayout_count() {
+    uint32_t count = 0;
+    for (size_t type = 0; type < (size_t)NodeType::Max; type++) {
+        count += Profiler::get_singleton()->get_frame_count((NodeType)type, ProfileCounter::Relayouts);
+    }
+    return count;
+}
+
+/// Layouts of all nodes after each frame.
+std::vector<FrameLayout> run_layout(uint32_t seed, uint32_t grain_size) {
+    auto app = App::create_headless(TEST_WINDOW_SIZE);
+    app->get_tree()->set_layout_grain_size(grain_size);
+
+    std::mt19937 rng(seed);
+
+    TestScene scene;
+    auto scene_root = build_random_subtree(scene, rng, 0);
+    scene_root->set_anchor_flag(AnchorFlag::FullRect);
+    app->get_tree_root()->add_child(scene_root);
+
+    std::vector<FrameLayout> frames;
+
+    for (uint32_t frame = 0; frame < TEST_FRAMES; frame++) {
+        // The first frame lays out the whole tree.
+        if (frame > 0) {
+            for (uint32_t i = 0; i < TEST_CHANGES; i++) {
+                scene.leaves[rng() % scene.leaves.size()]->set_custom_minimum_size(get_random_size(rng));
+            }
+            if (!scene.boxes.empty()) {
+                scene.boxes[rng() % scene.boxes.size()]->set_separation(rng() % 8);
+            }
+        }
+
+        app->single_run();
+
+        auto &layout = frames.emplace_back();
+        layout.relayouts = get_frame_relayout_count();
+        for (auto &node : scene.nodes) {
+            layout.nodes.push_back({node->get_position(),
+                                    node->get_size(),
+                                    node->get_global_position(),
+                                    node->get_global_bounds(),
+                                    node->is_layout_dirty(),
+                                    node->is_transform_dirty(),
+                                    node->is_transform_pending()});
+        }
+    }
+
+    return frames;
+}
+
+bool is_equal(Vec2F a, Vec2F b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+bool is_equal(const RectF &a, const RectF &b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+int main() {
+    int result = 0;
+
+    for (uint32_t seed = 0; seed < TEST_SEED_COUNT; seed++) {
+        auto serial = run_layout(seed, UINT32_MAX);
+        auto parallel = run_layout(seed, TEST_PARALLEL_GRAIN_SIZE);
+
+        bool identical = true;
+
+        for (uint32_t frame = 0; frame < TEST_FRAMES; frame++) {
+            if (serial[frame].relayouts != parallel[frame].relayouts) {
+                std::cerr << "Seed " << seed << ", frame " << frame << ": " << serial[frame].relayouts
+                          << " serial relayouts, " << parallel[frame].relayouts << " parallel relayouts" << std::endl;
+                identical = false;
+            }
+
+            for (size_t i = 0; i < serial[frame].nodes.size(); i++) {
+                auto &expected = serial[frame].nodes[i];
+                auto &actual = parallel[frame].nodes[i];
+
+                if (is_equal(expected.position, actual.position) && is_equal(expected.size, actual.size) &&
+                    is_equal(expected.global_position, actual.global_position) &&
+                    is_equal(expected.global_bounds, actual.global_bounds) &&
+                    expected.layout_dirty == actual.layout_dirty &&
+                    expected.transform_dirty == actual.transform_dirty &&
+                    expected.transform_pending == actual.transform_pending) {
+                    continue;
+                }
+
+                std::cerr << "Seed " << seed << ", frame " << frame << ", node " << i << ": serial position "
+                          << expected.position.x << "," << expected.position.y << " size " << expected.size.x << ","
+                          << expected.size.y << " dirty " << expected.layout_dirty << expected.transform_dirty
+                          << expected.transform_pending << ", parallel position " << actual.position.x << ","
+                          << actual.position.y << " size " << actual.size.x << "," << actual.size.y << " dirty "
+                          << actual.layout_dirty << actual.transform_dirty << actual.transform_pending << std::endl;
+                identical = false;
+                break;
+            }
+        }
+
+        std::cout << "Seed " << seed << ": " << serial.front().nodes.size() << " nodes, "
+                  << (identical ? "identical" : "mismatch") << std::endl;
+
+        if (!identical) {
+            result = 1;
+        }
+    }
+
+    return result;
+}